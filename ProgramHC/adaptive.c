@@ -0,0 +1,166 @@
+#include "adaptive.h"
+
+void AdhInit(AdhTree *t) {
+    for (int i = 0; i < ADH_SYMBOLS; i++) t->leaf[i] = -1;
+    // 一开始整棵树只有根，它就是NYT
+    t->node[ADH_ROOT].weight = 0;
+    t->node[ADH_ROOT].parent = -1;
+    t->node[ADH_ROOT].left = -1;
+    t->node[ADH_ROOT].right = -1;
+    t->node[ADH_ROOT].sym = ADH_NYT;
+    t->nyt = ADH_ROOT;
+}
+
+static void SetLeaf(AdhTree *t, int i, int parent, int sym) {
+    t->node[i].weight = 0;
+    t->node[i].parent = (short)parent;
+    t->node[i].left = -1;
+    t->node[i].right = -1;
+    t->node[i].sym = (short)sym;
+}
+
+// 节点内容搬到位置i后：修正孩子的父指针，或者字符/NYT到叶子的索引
+static void Relink(AdhTree *t, int i) {
+    AdhNode *x = &t->node[i];
+    if (x->left >= 0) {
+        t->node[x->left].parent = (short)i;
+        t->node[x->right].parent = (short)i;
+    } else if (x->sym == ADH_NYT) {
+        t->nyt = i;
+    } else {
+        t->leaf[x->sym] = (short)i;
+    }
+}
+
+// 交换位置a、b上的子树（父指针留在原位置，因为父节点指向的是位置）
+static void Swap(AdhTree *t, int a, int b) {
+    AdhNode x = t->node[a];
+    short pa = t->node[a].parent, pb = t->node[b].parent;
+    t->node[a] = t->node[b];
+    t->node[a].parent = pa;
+    t->node[b] = x;
+    t->node[b].parent = pb;
+    Relink(t, a);
+    Relink(t, b);
+}
+
+void AdhUpdate(AdhTree *t, int sym) {
+    int q = t->leaf[sym];
+
+    if (q < 0) {
+        // 新字符：NYT分裂成内部节点，左孩子是新的NYT，右孩子是这个字符的叶子（权重都是0）
+        int z = t->nyt;
+        t->node[z].sym = -1;
+        t->node[z].left = (short)(z - 2);
+        t->node[z].right = (short)(z - 1);
+        SetLeaf(t, z - 2, z, ADH_NYT);
+        SetLeaf(t, z - 1, z, sym);
+        t->nyt = z - 2;
+        t->leaf[sym] = (short)(z - 1);
+        q = z - 1;
+    }
+    // 从叶子往上：先换到同权重的块首（不能是自己的父节点），再加1，然后处理父节点
+    while (q != ADH_ROOT) {
+        unsigned int w = t->node[q].weight;
+        int lead = q;
+        while (lead < ADH_ROOT && t->node[lead + 1].weight == w) lead++;
+        if (lead != q && lead != t->node[q].parent) {
+            Swap(t, q, lead);
+            q = lead;
+        }
+        t->node[q].weight++;
+        q = t->node[q].parent;
+    }
+    // 根的权重就是已处理的字符数；快到上限时两端在同一个字符之后一起清空重来，权重不会溢出
+    if (++t->node[ADH_ROOT].weight >= ADH_MAX_WEIGHT) AdhInit(t);
+}
+
+// 输出从根到叶子q的路径（左0右1）：从叶子往上收集，先收集的在低位；
+// 凑满32位才存进word，常见的短码只用一个寄存器
+static void PutPath(const AdhTree *t, BitWriter *bw, int q) {
+    unsigned int word[(ADH_NODES + 31) / 32], cur = 0;
+    int full = 0, d = 0;
+    for (int p = t->node[q].parent; p >= 0; q = p, p = t->node[p].parent) {
+        cur |= (unsigned int)(t->node[p].right == q) << d;
+        if (++d == 32) {
+            word[full++] = cur;
+            cur = 0;
+            d = 0;
+        }
+    }
+    if (d > 0) PutBits(bw, cur, d);
+    while (full > 0) PutBits(bw, word[--full], 32);
+}
+
+static void EncodeSymbol(AdhTree *t, BitWriter *bw, int sym) {
+    if (t->leaf[sym] >= 0) {
+        PutPath(t, bw, t->leaf[sym]);
+    } else {
+        PutPath(t, bw, t->nyt);
+        PutBits(bw, (unsigned int)sym, 9);
+    }
+    if (sym != ADH_EOF) AdhUpdate(t, sym);
+}
+
+void AdhEncode(AdhTree *t, BitWriter *bw, const unsigned char *src, size_t len) {
+    for (size_t i = 0; i < len; i++) EncodeSymbol(t, bw, src[i]);
+}
+
+void AdhEncodeEnd(AdhTree *t, BitWriter *bw) {
+    EncodeSymbol(t, bw, ADH_EOF);
+}
+
+void AdhInitReader(AdhReader *r, FILE *fp, const unsigned char *mem, size_t len) {
+    r->fp = fp;
+    r->p = mem;
+    r->end = mem + len;
+    r->left = 0;
+    r->byte = 0;
+}
+
+// 取一位，码流用完返回-1
+static int GetBit(AdhReader *r) {
+    if (r->left == 0) {
+        if (r->p == r->end) {
+            size_t got;
+            if (r->fp == NULL || (got = fread(r->buf, 1, sizeof(r->buf), r->fp)) == 0) return -1;
+            r->p = r->buf;
+            r->end = r->buf + got;
+        }
+        r->byte = *r->p++;
+        r->left = 8;
+    }
+    r->left--;
+    return (int)(r->byte >> r->left & 1);
+}
+
+long long AdhDecode(AdhTree *t, AdhReader *r, unsigned char *dst, size_t max, int *eof) {
+    size_t out = 0;
+
+    *eof = 0;
+    while (out < max) {
+        int q = ADH_ROOT, sym;
+        while (t->node[q].left >= 0) {
+            int bit = GetBit(r);
+            if (bit < 0) return -1;
+            q = bit ? t->node[q].right : t->node[q].left;
+        }
+        sym = t->node[q].sym;
+        if (sym == ADH_NYT) {           // 新字符：后面跟着9位原值
+            sym = 0;
+            for (int i = 0; i < 9; i++) {
+                int bit = GetBit(r);
+                if (bit < 0) return -1;
+                sym = sym << 1 | bit;
+            }
+            if (sym == ADH_EOF) {
+                *eof = 1;
+                break;
+            }
+            if (sym > ADH_EOF || t->leaf[sym] >= 0) return -1;
+        }
+        dst[out++] = (unsigned char)sym;
+        AdhUpdate(t, sym);
+    }
+    return (long long)out;
+}
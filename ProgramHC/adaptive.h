@@ -0,0 +1,54 @@
+#ifndef ADAPTIVE_H
+#define ADAPTIVE_H
+
+#include <stdio.h>
+#include "huffman.h"    // BitWriter
+
+// 自适应哈夫曼编码（FGK算法）：编码端和解码端各自维护同一棵树，每处理一个字符就更新一次，
+// 不需要先统计频率、也不用传码表，只扫一遍输入，适合管道、套接字这类不能回头重读的流。
+// 字符第一次出现时先输出NYT（尚未出现）叶子的编码，再输出9位原值；原值256表示流结束。
+//
+// 树用数组存放，下标就是FGK的节点序号：权重随下标不降、兄弟相邻（兄弟性质），根在最后。
+// 更新时把节点与同权重中序号最大的节点（块首）交换位置再加1，交换只搬动两个位置上的内容。
+#define ADH_SYMBOLS 257                     // 256个字节值 + 结束符
+#define ADH_EOF 256
+#define ADH_NYT ADH_SYMBOLS                 // NYT叶子的sym
+#define ADH_NODES (2 * (ADH_SYMBOLS + 1) - 1)   // 最多257个字符叶子 + NYT
+#define ADH_ROOT (ADH_NODES - 1)
+#define ADH_MAX_BITS (ADH_NODES + 9)        // 一个字符最多输出的位数：树深 + 9位原值
+#define ADH_MAX_WEIGHT (1u << 30)           // 根权重到这里就重建树
+
+typedef struct {
+    unsigned int weight;
+    short parent, left, right;  // 没有时为-1；left为-1表示叶子
+    short sym;                  // 叶子对应的字符（ADH_NYT是NYT），内部节点为-1
+} AdhNode;
+
+typedef struct {
+    AdhNode node[ADH_NODES];
+    short leaf[ADH_SYMBOLS];    // 字符 -> 叶子下标（-1表示还没出现），编码时不必查找
+    int nyt;                    // NYT叶子的下标
+} AdhTree;
+
+// 读码流：从文件（fp不为NULL）或一段内存读入，按位取出（高位在前）
+typedef struct {
+    FILE *fp;
+    const unsigned char *p, *end;
+    unsigned int byte;          // 当前字节
+    int left;                   // 当前字节还剩几位没取
+    unsigned char buf[1 << 16];
+} AdhReader;
+
+void AdhInit(AdhTree *t);
+void AdhUpdate(AdhTree *t, int sym);    // 字符sym又出现一次，更新树
+
+// 编码len个字节写入bw，输出空间至少要len×ADH_MAX_BITS/8+8字节
+void AdhEncode(AdhTree *t, BitWriter *bw, const unsigned char *src, size_t len);
+// 写结束符（之后用FlushBits补齐最后一个字节）
+void AdhEncodeEnd(AdhTree *t, BitWriter *bw);
+
+void AdhInitReader(AdhReader *r, FILE *fp, const unsigned char *mem, size_t len);
+// 译出字符写入dst，最多max个，读到结束符时*eof置1；返回译出的字符数，码流损坏或提前结束返回-1
+long long AdhDecode(AdhTree *t, AdhReader *r, unsigned char *dst, size_t max, int *eof);
+
+#endif // ADAPTIVE_H
@@ -0,0 +1,287 @@
+#include <string.h>
+#include "fse.h"
+
+// 最高位的位置（v>0）
+static int HighBit(unsigned int v) {
+    int k = 0;
+    while (v >>= 1) k++;
+    return k;
+}
+
+// log2(v)的定点数（16位小数），v>0：尾数m∈[1,2)反复平方，每次m²≥2就得到一位1
+static unsigned int Log2Fixed(unsigned int v) {
+    int k = HighBit(v);
+    unsigned long long m = (unsigned long long)v << 30 >> k;    // Q30
+    unsigned int r = (unsigned int)k << 16;
+    for (int b = 15; b >= 0; b--) {
+        m = m * m >> 30;
+        if (m >= 1ull << 31) {
+            r |= 1u << b;
+            m >>= 1;
+        }
+    }
+    return r;
+}
+
+// ====================== 归一化与表头 ======================
+int FseNormalize(const unsigned int count[FSE_SYMBOLS], size_t total, int tablelog, short norm[FSE_SYMBOLS]) {
+    int size = 1 << tablelog, sum = 0, cnt = 0;
+
+    for (int s = 0; s < FSE_SYMBOLS; s++) {
+        unsigned long long v = 0;
+        if (count[s]) {
+            v = ((unsigned long long)count[s] * (unsigned long long)size + total / 2) / total;
+            if (v == 0) v = 1;
+            cnt++;
+        }
+        norm[s] = (short)v;
+        sum += (int)v;
+    }
+    if (cnt < 2 || cnt > size) return 0;
+    // 四舍五入后和不一定正好是L：多了就从count/norm最小的字符减（每少1损失约count/norm位），
+    // 少了就给count/norm最大的字符加
+    while (sum != size) {
+        int best = -1;
+        for (int s = 0; s < FSE_SYMBOLS; s++) {
+            if (count[s] == 0 || (sum > size && norm[s] <= 1)) continue;
+            if (best < 0) {
+                best = s;
+            } else {
+                unsigned long long a = (unsigned long long)count[s] * (unsigned long long)norm[best];
+                unsigned long long b = (unsigned long long)count[best] * (unsigned long long)norm[s];
+                if (sum > size ? a < b : a > b) best = s;
+            }
+        }
+        norm[best] = (short)(norm[best] + (sum > size ? -1 : 1));
+        sum += sum > size ? -1 : 1;
+    }
+    return cnt;
+}
+
+unsigned long long FseCodedBits(const unsigned int count[FSE_SYMBOLS], const short norm[FSE_SYMBOLS], int tablelog) {
+    unsigned long long bits = 0;      // 16位小数
+    for (int s = 0; s < FSE_SYMBOLS; s++) {
+        if (count[s]) bits += (unsigned long long)count[s] * (((unsigned int)tablelog << 16) - Log2Fixed((unsigned int)norm[s]));
+    }
+    return (bits + 32768) >> 16;
+}
+
+size_t FseWriteHeader(unsigned char *dst, const short norm[FSE_SYMBOLS], int tablelog) {
+    unsigned char *p = dst + 33;
+    unsigned long long acc = 0;
+    int n = 0;
+
+    dst[0] = (unsigned char)tablelog;
+    memset(dst + 1, 0, 32);
+    for (int s = 0; s < FSE_SYMBOLS; s++) {
+        if (norm[s] == 0) continue;
+        dst[1 + (s >> 3)] |= (unsigned char)(1 << (s & 7));
+        acc |= (unsigned long long)(norm[s] - 1) << n;
+        n += tablelog;
+        while (n >= 8) {
+            *p++ = (unsigned char)acc;
+            acc >>= 8;
+            n -= 8;
+        }
+    }
+    if (n > 0) *p++ = (unsigned char)acc;
+    return (size_t)(p - dst);
+}
+
+size_t FseReadHeader(const unsigned char *src, size_t src_len, short norm[FSE_SYMBOLS], int *tablelog) {
+    const unsigned char *p = src + 33, *end = src + src_len;
+    unsigned long long acc = 0;
+    int n = 0, sum = 0, cnt = 0, log;
+
+    if (src_len < 33) return 0;
+    log = src[0];
+    if (log < FSE_MIN_LOG || log > FSE_MAX_LOG) return 0;
+    for (int s = 0; s < FSE_SYMBOLS; s++) {
+        norm[s] = 0;
+        if (!(src[1 + (s >> 3)] >> (s & 7) & 1)) continue;
+        while (n < log) {
+            if (p == end) return 0;
+            acc |= (unsigned long long)*p++ << n;
+            n += 8;
+        }
+        norm[s] = (short)((acc & ((1u << log) - 1)) + 1);
+        acc >>= log;
+        n -= log;
+        sum += norm[s];
+        cnt++;
+    }
+    if (sum != 1 << log || cnt < 2) return 0;
+    *tablelog = log;
+    return (size_t)(p - src);
+}
+
+// ====================== 建表 ======================
+// 把L个状态分给各字符：每个字符占norm个，按奇数步长跳着放，使同一字符的状态散布在整张表里
+static void Spread(const short norm[FSE_SYMBOLS], int tablelog, unsigned char tab[]) {
+    int size = 1 << tablelog, mask = size - 1, step = (size >> 1) + (size >> 3) + 3, pos = 0;
+    for (int s = 0; s < FSE_SYMBOLS; s++) {
+        for (int i = 0; i < norm[s]; i++) {
+            tab[pos] = (unsigned char)s;
+            pos = (pos + step) & mask;
+        }
+    }
+}
+
+void FseBuildEncodeTable(FseEncodeTable *ct, const short norm[FSE_SYMBOLS], int tablelog) {
+    unsigned char tab[1 << FSE_MAX_LOG];
+    int size = 1 << tablelog, cumul[FSE_SYMBOLS], next[FSE_SYMBOLS], total = 0;
+
+    Spread(norm, tablelog, tab);
+    for (int s = 0; s < FSE_SYMBOLS; s++) {
+        cumul[s] = next[s] = total;
+        total += norm[s];
+    }
+    for (int x = 0; x < size; x++) ct->state[next[tab[x]]++] = (unsigned short)(size + x);
+    ct->tablelog = tablelog;
+    for (int s = 0; s < FSE_SYMBOLS; s++) {
+        int k = norm[s], most;
+        if (k == 0) continue;
+        most = tablelog - (k > 1 ? HighBit((unsigned int)k - 1) : 0);
+        ct->sym[s].nbits = ((unsigned int)most << 16) - ((unsigned int)k << most);
+        ct->sym[s].find = cumul[s] - k;
+    }
+}
+
+void FseBuildDecodeTable(FseDecodeEntry dt[], const short norm[FSE_SYMBOLS], int tablelog) {
+    unsigned char tab[1 << FSE_MAX_LOG];
+    int size = 1 << tablelog, next[FSE_SYMBOLS];
+
+    Spread(norm, tablelog, tab);
+    for (int s = 0; s < FSE_SYMBOLS; s++) next[s] = norm[s];
+    for (int x = 0; x < size; x++) {
+        int k = next[tab[x]]++, nb = tablelog - HighBit((unsigned int)k);
+        dt[x].sym = tab[x];
+        dt[x].nbits = (unsigned char)nb;
+        dt[x].next = (unsigned short)((k << nb) - size);
+    }
+}
+
+// ====================== 编码 ======================
+// 输出状态的低nb位，转到下一状态
+#define FSE_ENCODE(st, c) do { \
+        unsigned int nb_ = ((st) + ct->sym[c].nbits) >> 16; \
+        acc |= (unsigned long long)((st) & ((1u << nb_) - 1)) << n; \
+        n += (int)nb_; \
+        (st) = ct->state[((st) >> nb_) + ct->sym[c].find]; \
+    } while (0)
+
+size_t FseEncode(const FseEncodeTable *ct, const unsigned char *src, size_t len, unsigned char *dst, size_t cap) {
+    unsigned int size = 1u << ct->tablelog, st0 = size, st1 = size;
+    unsigned long long acc = 0;
+    unsigned char *p = dst, *end = dst + cap;
+    size_t i = len;
+    int n = 0;
+
+    // 从后往前，下标为偶数的用状态0、奇数的用状态1；每两个字符最多24位，凑满32位写出
+    if (i & 1) {
+        i--;
+        FSE_ENCODE(st0, src[i]);
+    }
+    while (i > 0) {
+        i -= 2;
+        FSE_ENCODE(st1, src[i + 1]);
+        FSE_ENCODE(st0, src[i]);
+        if (n >= 32) {
+            if (end - p < 4) return 0;
+            p[0] = (unsigned char)acc;
+            p[1] = (unsigned char)(acc >> 8);
+            p[2] = (unsigned char)(acc >> 16);
+            p[3] = (unsigned char)(acc >> 24);
+            p += 4;
+            acc >>= 32;
+            n -= 32;
+        }
+    }
+    // 最后是两个状态和标记位，补齐到字节
+    acc |= (unsigned long long)(st0 - size) << n;
+    n += ct->tablelog;
+    acc |= (unsigned long long)(st1 - size) << n;
+    n += ct->tablelog;
+    acc |= 1ull << n;
+    n++;
+    while (n > 0) {
+        if (p == end) return 0;
+        *p++ = (unsigned char)acc;
+        acc >>= 8;
+        n -= 8;
+    }
+    return (size_t)(p - dst);
+}
+
+// ====================== 解码 ======================
+// 倒着取nb位（pos是还没读的位数）：逐位拼起来，只在码流两头、不能整字读时用
+static unsigned int ReadBack(const unsigned char *src, long long *pos, int nb, int *bad) {
+    unsigned int v = 0;
+    if (*pos < nb) {
+        *bad = 1;
+        return 0;
+    }
+    *pos -= nb;
+    for (int k = nb - 1; k >= 0; k--) v = v << 1 | (src[(*pos + k) >> 3] >> ((*pos + k) & 7) & 1);
+    return v;
+}
+
+// 从字节p开始按小端取8个字节
+static inline unsigned long long Load64LE(const unsigned char *p) {
+#if defined(__GNUC__)
+    unsigned long long v;
+    memcpy(&v, p, 8);
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    v = __builtin_bswap64(v);
+#endif
+    return v;
+#else
+    unsigned long long v = 0;
+    for (int k = 7; k >= 0; k--) v = v << 8 | p[k];
+    return v;
+#endif
+}
+
+// 译出一个字符，从窗口w里取下一状态要补的位
+#define FSE_DECODE(st, out) do { \
+        FseDecodeEntry e_ = dt[st]; \
+        (out) = e_.sym; \
+        sh -= e_.nbits; \
+        (st) = e_.next + (unsigned int)(w >> sh & ((1u << e_.nbits) - 1)); \
+    } while (0)
+
+int FseDecode(const FseDecodeEntry dt[], int tablelog, const unsigned char *src, size_t src_len,
+              unsigned char *dst, size_t raw_len) {
+    long long pos;
+    unsigned int st0, st1;
+    size_t i = 0;
+    int bad = 0;
+
+    if (src_len == 0 || src[src_len - 1] == 0) return 0;
+    pos = (long long)src_len * 8 - 8 + HighBit(src[src_len - 1]);     // 标记位以下都是数据
+    st1 = ReadBack(src, &pos, tablelog, &bad);
+    st0 = ReadBack(src, &pos, tablelog, &bad);
+    // 主循环：读一次8字节，窗口里pos以下至少有56位，够两个状态各译两个字符（最多48位）；
+    // 每个字符查一次表、移位取位，没有依赖数据的分支
+    while (!bad && i + 4 <= raw_len && pos >= 56) {
+        unsigned long long w = Load64LE(src + (pos >> 3) - 7);
+        int top = 56 + (int)(pos & 7), sh = top;
+        FSE_DECODE(st0, dst[i]);
+        FSE_DECODE(st1, dst[i + 1]);
+        FSE_DECODE(st0, dst[i + 2]);
+        FSE_DECODE(st1, dst[i + 3]);
+        i += 4;
+        pos -= top - sh;
+    }
+    // 剩下的（码流开头附近、最后不足四个字符）逐个译
+    while (!bad && i < raw_len) {
+        if (i & 1) {
+            dst[i++] = dt[st1].sym;
+            st1 = dt[st1].next + ReadBack(src, &pos, dt[st1].nbits, &bad);
+        } else {
+            dst[i++] = dt[st0].sym;
+            st0 = dt[st0].next + ReadBack(src, &pos, dt[st0].nbits, &bad);
+        }
+    }
+    return !bad && pos == 0 && st0 == 0 && st1 == 0;
+}
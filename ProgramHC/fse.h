@@ -0,0 +1,54 @@
+#ifndef FSE_H
+#define FSE_H
+
+#include <stddef.h>
+
+// 表驱动的ANS熵编码（tANS，即FSE）：与哈夫曼一样查表编解码，但状态里带着小数位，
+// 每个字符平均花log2(L/norm)位而不是整数位，概率大的字符（>1/2）也能少于1位。
+// 各字符的出现次数先归一化成norm（和为L=2^tablelog），编码从后往前，解码从前往后。
+// 这里用两个状态交错：偶数下标的字符用状态0，奇数的用状态1，解码时两条依赖链可以同时推进。
+//
+// 码流：编码时低位在前逐字节写出，最后写入状态0、状态1（各tablelog位）和一个标记位1；
+// 解码从末尾的标记位开始倒着读。两个状态的初值都是L，解完后必须回到0（解码端的状态是x-L），
+// 且正好读完所有位，否则视为数据损坏。
+#define FSE_MIN_LOG 5
+#define FSE_MAX_LOG 12
+#define FSE_TABLE_LOG 11            // 默认2048个状态，解码表8KB，在L1里
+#define FSE_SYMBOLS 256
+
+typedef struct {
+    int tablelog;
+    unsigned short state[1 << FSE_MAX_LOG];   // 按(字符, 序号)排好的下一状态（L..2L-1）
+    struct {
+        int find;               // 字符在state里的起点 - norm
+        unsigned int nbits;     // (最多输出的位数<<16) - (norm<<最多输出的位数)，加上状态后>>16就是本次位数
+    } sym[FSE_SYMBOLS];
+} FseEncodeTable;
+
+typedef struct {
+    unsigned short next;        // 下一状态的基数，加上读入的nbits位
+    unsigned char sym;
+    unsigned char nbits;
+} FseDecodeEntry;
+
+// 把出现次数归一化成和为2^tablelog的norm（出现过的至少1），尽量少损失压缩率；
+// 返回出现的字符数，少于2个或多于2^tablelog个时返回0（不适合用tANS）
+int FseNormalize(const unsigned int count[FSE_SYMBOLS], size_t total, int tablelog, short norm[FSE_SYMBOLS]);
+// 按norm估算码流位数：Σ count×log2(L/norm)
+unsigned long long FseCodedBits(const unsigned int count[FSE_SYMBOLS], const short norm[FSE_SYMBOLS], int tablelog);
+
+// norm表：u8 tablelog，32字节的出现位图，然后是各个出现字符的norm-1（每个tablelog位，低位在前）
+size_t FseWriteHeader(unsigned char *dst, const short norm[FSE_SYMBOLS], int tablelog);
+// 读norm表并检查（和必须为L），返回占用的字节数，格式错误返回0
+size_t FseReadHeader(const unsigned char *src, size_t src_len, short norm[FSE_SYMBOLS], int *tablelog);
+
+void FseBuildEncodeTable(FseEncodeTable *ct, const short norm[FSE_SYMBOLS], int tablelog);
+void FseBuildDecodeTable(FseDecodeEntry dt[], const short norm[FSE_SYMBOLS], int tablelog);
+
+// 编码len个字节写入dst（最多cap字节），返回码流字节数；放不下返回0
+size_t FseEncode(const FseEncodeTable *ct, const unsigned char *src, size_t len, unsigned char *dst, size_t cap);
+// 从码流译出raw_len个字节，成功返回1，数据损坏返回0
+int FseDecode(const FseDecodeEntry dt[], int tablelog, const unsigned char *src, size_t src_len,
+              unsigned char *dst, size_t raw_len);
+
+#endif // FSE_H
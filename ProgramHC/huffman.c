@@ -0,0 +1,730 @@
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../bytehist.h"
+#include "fse.h"
+#include "huffman.h"
+
+// 清空父子关系（叶子的ch、weight保持不变）
+static void ResetLinks(Htreetype ht[], int cnt) {
+    for (int i = 0; i < 2 * cnt - 1; i++) {
+        ht[i].parent = -1;
+        ht[i].Lchild = -1;
+        ht[i].Rchild = -1;
+    }
+}
+
+// 把s1、s2合并成新节点k
+static void Merge(Htreetype ht[], int k, int s1, int s2) {
+    ht[s1].parent = k;
+    ht[s2].parent = k;
+    ht[k].Lchild = s1;
+    ht[k].Rchild = s2;
+    ht[k].weight = ht[s1].weight + ht[s2].weight;
+}
+
+// 原来的建树方法：每次合并都扫描0~k-1，找两个无父节点的最小权重节点
+void HuffmanBuildScan(Htreetype ht[], int cnt) {
+    ResetLinks(ht, cnt);
+    for (int k = cnt; k < 2 * cnt - 1; k++) {
+        int min1 = INT_MAX, min2 = INT_MAX, idx1 = -1, idx2 = -1;
+        for (int i = 0; i < k; i++) {
+            if (ht[i].parent == -1 && ht[i].weight < min1) {
+                min2 = min1;
+                idx2 = idx1;
+                min1 = ht[i].weight;
+                idx1 = i;
+            } else if (ht[i].parent == -1 && ht[i].weight < min2) {
+                min2 = ht[i].weight;
+                idx2 = i;
+            }
+        }
+        Merge(ht, k, idx1, idx2);
+    }
+}
+
+// 小根堆的下沉。堆元素是 (权重<<32 | 下标)，一次整数比较就是按(权重, 下标)的字典序，
+// 不必再回到ht[]里取权重（节点多时那是一次缓存缺失）
+static void SiftDown(unsigned long long heap[], int size, int i) {
+    unsigned long long x = heap[i];
+    for (;;) {
+        int c = 2 * i + 1;
+        if (c >= size) break;
+        if (c + 1 < size && heap[c + 1] < heap[c]) c++;
+        if (heap[c] >= x) break;
+        heap[i] = heap[c];
+        i = c;
+    }
+    heap[i] = x;
+}
+
+#define HEAP_KEY(ht, i) ((unsigned long long)(unsigned int)(ht)[i].weight << 32 | (unsigned int)(i))
+
+// 二叉堆建树：每次弹出两个最小节点，合并出的新节点直接替换堆顶再下沉
+void HuffmanBuildHeap(Htreetype ht[], int cnt) {
+    unsigned long long *heap;
+    int size = cnt;
+
+    ResetLinks(ht, cnt);
+    if (cnt <= 1) return;
+    heap = (unsigned long long *)malloc(cnt * sizeof(unsigned long long));
+    if (heap == NULL) {
+        printf("错误！内存分配失败\n");
+        exit(1);
+    }
+    for (int i = 0; i < cnt; i++) heap[i] = HEAP_KEY(ht, i);
+    for (int i = cnt / 2 - 1; i >= 0; i--) SiftDown(heap, size, i);
+
+    for (int k = cnt; k < 2 * cnt - 1; k++) {
+        int s1 = (int)(heap[0] & 0xFFFFFFFFu), s2;
+        heap[0] = heap[--size];             // 弹出最小
+        SiftDown(heap, size, 0);
+        s2 = (int)(heap[0] & 0xFFFFFFFFu);  // 次小留在堆顶，合并后被新节点替换
+        Merge(ht, k, s1, s2);
+        heap[0] = HEAP_KEY(ht, k);
+        SiftDown(heap, size, 0);
+    }
+    free(heap);
+}
+
+// 双队列建树：叶子按权重有序时，合并出的节点权重也单调不降，
+// 两个队列（叶子、非叶子）的队头里取较小者即可，不需要堆
+int HuffmanBuildSorted(Htreetype ht[], int cnt) {
+    int leaf = 0, inner = cnt;      // 两个队列的队头；非叶子队列的队尾就是k
+
+    for (int i = 1; i < cnt; i++) {
+        if (ht[i].weight < ht[i - 1].weight) return 0;
+    }
+    ResetLinks(ht, cnt);
+    for (int k = cnt; k < 2 * cnt - 1; k++) {
+        int s[2];
+        for (int j = 0; j < 2; j++) {
+            // 权重相同时叶子下标更小，优先取叶子
+            if (leaf < cnt && (inner >= k || ht[leaf].weight <= ht[inner].weight)) s[j] = leaf++;
+            else s[j] = inner++;
+        }
+        Merge(ht, k, s[0], s[1]);
+    }
+    return 1;
+}
+
+// ====================== 限长编码（package-merge） ======================
+static int CompareKey(const void *a, const void *b) {
+    unsigned long long x = *(const unsigned long long *)a, y = *(const unsigned long long *)b;
+    return x < y ? -1 : x > y;
+}
+
+// 把“码长不超过L”看成凑硬币：每个字符在第1~L层各有一枚面值2^-l、代价为其权重的硬币，
+// 凑出面值cnt-1且代价最小。从最深一层起，每层把上一层相邻两项打成一个包，与叶子归并排序；
+// 顶层取前2cnt-2项，再逐层展开：选中的叶子码长+1，选中的包对应下一层的前2×包数项
+int HufLimitLengths(const unsigned int weight[], int cnt, int maxbits, int len[]) {
+    unsigned long long *leaf, *cur, *prev, *tmp;
+    int *kind;          // kind[l*width+i]：第l层（0是最深层）第i项是叶子（字符下标）还是包（-1）
+    int width = 2 * cnt, total;
+
+    if (cnt < 1 || maxbits < 1 || maxbits > HUF_DECODE_MAXLEN || cnt > 1 << maxbits) return 0;
+    if (cnt == 1) {
+        len[0] = 1;
+        return 1;
+    }
+    leaf = (unsigned long long *)malloc(cnt * sizeof(unsigned long long));
+    cur = (unsigned long long *)malloc(width * sizeof(unsigned long long));
+    prev = (unsigned long long *)malloc(width * sizeof(unsigned long long));
+    kind = (int *)malloc((size_t)maxbits * width * sizeof(int));
+    if (leaf == NULL || cur == NULL || prev == NULL || kind == NULL) {
+        free(leaf);
+        free(cur);
+        free(prev);
+        free(kind);
+        return 0;
+    }
+    for (int i = 0; i < cnt; i++) leaf[i] = (unsigned long long)weight[i] << 32 | (unsigned int)i;
+    qsort(leaf, cnt, sizeof(unsigned long long), CompareKey);
+
+    // 最深一层只有叶子；往上每层 = 叶子 + 下一层两两打包，按权重归并（权重相同叶子在前）
+    for (int i = 0; i < cnt; i++) {
+        prev[i] = leaf[i] >> 32;
+        kind[i] = (int)(leaf[i] & 0xFFFFFFFFu);
+    }
+    total = cnt;
+    for (int l = 1; l < maxbits; l++) {
+        int pkgs = total / 2, a = 0, b = 0, k = 0;
+        while (a < cnt || b < pkgs) {
+            unsigned long long pw = b < pkgs ? prev[2 * b] + prev[2 * b + 1] : ~0ull;
+            if (a < cnt && leaf[a] >> 32 <= pw) {
+                cur[k] = leaf[a] >> 32;
+                kind[l * width + k] = (int)(leaf[a++] & 0xFFFFFFFFu);
+            } else {
+                cur[k] = pw;
+                kind[l * width + k] = -1;
+                b++;
+            }
+            k++;
+        }
+        total = k;
+        tmp = cur;
+        cur = prev;
+        prev = tmp;
+    }
+
+    for (int i = 0; i < cnt; i++) len[i] = 0;
+    total = 2 * cnt - 2;
+    for (int l = maxbits - 1; l >= 0; l--) {
+        int pkgs = 0;
+        for (int i = 0; i < total; i++) {
+            if (kind[l * width + i] >= 0) len[kind[l * width + i]]++;
+            else pkgs++;
+        }
+        total = 2 * pkgs;
+    }
+    free(leaf);
+    free(cur);
+    free(prev);
+    free(kind);
+    return 1;
+}
+
+// ====================== 查表译码 ======================
+#define SUB_FLAG 0x80000000u
+
+int HufCanonicalCodes(const int len[], int cnt, unsigned int code[]) {
+    int bl_count[HUF_DECODE_MAXLEN + 1] = {0};      // 每种码长的字符数
+    unsigned int next[HUF_DECODE_MAXLEN + 1];       // 每种码长下一个要分配的编码
+    unsigned int c = 0;
+
+    for (int i = 0; i < cnt; i++) {
+        if (len[i] < 0 || len[i] > HUF_DECODE_MAXLEN) return 0;
+        bl_count[len[i]]++;
+    }
+    bl_count[0] = 0;
+    // 码长l的第一个编码 = (码长l-1的第一个编码 + 码长l-1的个数) << 1
+    for (int l = 1; l <= HUF_DECODE_MAXLEN; l++) {
+        c = (c + (unsigned int)bl_count[l - 1]) << 1;
+        next[l] = c;
+        if (c + (unsigned int)bl_count[l] > 1u << l) return 0;     // 这一层的编码不够分
+    }
+    for (int i = 0; i < cnt; i++) {
+        if (len[i]) code[i] = next[len[i]]++;
+    }
+    return 1;
+}
+
+int HufBuildTable(HufTable *t, const unsigned int code[], const int len[], const unsigned char sym[], int cnt) {
+    int sub_bits[1 << HUF_TABLE_BITS] = {0};    // 每个长码前缀的二级表位数
+    int sub_off[1 << HUF_TABLE_BITS];
+    int size = 1 << HUF_TABLE_BITS;
+    unsigned int *pair;
+
+    t->entry = NULL;
+    t->maxlen = 0;
+    for (int i = 0; i < cnt; i++) {
+        if (len[i] < 1 || len[i] > HUF_DECODE_MAXLEN) return 0;
+        if (len[i] > t->maxlen) t->maxlen = len[i];
+        if (len[i] > HUF_TABLE_BITS) {
+            int prefix = (int)(code[i] >> (len[i] - HUF_TABLE_BITS));
+            if (len[i] - HUF_TABLE_BITS > sub_bits[prefix]) sub_bits[prefix] = len[i] - HUF_TABLE_BITS;
+        }
+    }
+    for (int i = 0; i < 1 << HUF_TABLE_BITS; i++) {
+        sub_off[i] = size;
+        size += sub_bits[i] ? 1 << sub_bits[i] : 0;
+    }
+    t->pair = size;
+    t->entry = (unsigned int *)calloc(size + (1 << HUF_TABLE_BITS), sizeof(unsigned int));
+    if (t->entry == NULL) return 0;
+    for (int i = 0; i < 1 << HUF_TABLE_BITS; i++) {
+        if (sub_bits[i]) t->entry[i] = SUB_FLAG | (unsigned int)sub_off[i] << 5 | (unsigned int)sub_bits[i];
+    }
+
+    // 单字符表
+    for (int i = 0; i < cnt; i++) {
+        unsigned int e = (unsigned int)len[i] | (unsigned int)sym[i] << 8;
+        unsigned int *base;
+        int room;       // 该编码后面还空着的位数：前缀相同的2^room项都填它
+        unsigned int first;
+        if (len[i] <= HUF_TABLE_BITS) {
+            base = t->entry;
+            room = HUF_TABLE_BITS - len[i];
+            first = code[i] << room;
+        } else {
+            int prefix = (int)(code[i] >> (len[i] - HUF_TABLE_BITS));
+            int rest = len[i] - HUF_TABLE_BITS;
+            base = t->entry + sub_off[prefix];
+            room = sub_bits[prefix] - rest;
+            first = (code[i] & ((1u << rest) - 1)) << room;
+        }
+        for (unsigned int k = 0; k < 1u << room; k++) base[first + k] = e;
+    }
+
+    // 双字符表：第一个码之后剩下的位（未知的低位按0处理）若已能确定第二个码，就把两个合成一项
+    pair = t->entry + t->pair;
+    for (unsigned int v = 0; v < 1u << HUF_TABLE_BITS; v++) {
+        unsigned int e1 = t->entry[v], e2;
+        int l1 = (int)(e1 & 0xFF), l2;
+        pair[v] = e1;
+        if ((e1 & SUB_FLAG) || l1 == 0 || l1 >= HUF_TABLE_BITS) continue;
+        e2 = t->entry[(v << l1) & ((1u << HUF_TABLE_BITS) - 1)];
+        l2 = (int)(e2 & 0xFF);
+        if (!(e2 & SUB_FLAG) && l2 > 0 && l1 + l2 <= HUF_TABLE_BITS) {
+            pair[v] = (unsigned int)(l1 + l2) | (e1 & 0xFF00) | (e2 & 0xFF00) << 8 | 1u << 24;
+        }
+    }
+    return 1;
+}
+
+void HufFreeTable(HufTable *t) {
+    free(t->entry);
+    t->entry = NULL;
+}
+
+// 从字节p开始按大端取8个字节
+static inline unsigned long long Load64BE(const unsigned char *p) {
+#if defined(__GNUC__)
+    unsigned long long v;
+    memcpy(&v, p, 8);
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    v = __builtin_bswap64(v);
+#endif
+    return v;
+#else
+    unsigned long long v = 0;
+    for (int i = 0; i < 8; i++) v = v << 8 | p[i];
+    return v;
+#endif
+}
+
+// 查表得到window（左对齐）开头那个编码的表项；main是单字符或双字符主表
+static inline unsigned int Lookup(const unsigned int *tab, const unsigned int *main, unsigned long long window) {
+    unsigned int e = main[window >> (64 - HUF_TABLE_BITS)];
+    if (e & SUB_FLAG) {
+        int k = (int)(e & 31);
+        e = tab[((e & ~SUB_FLAG) >> 5) + (unsigned int)((window << HUF_TABLE_BITS) >> (64 - k))];
+    }
+    return e;
+}
+
+// 快速路径里译一个码：查表，写出1~2个字符，窗口左移。非法码（码长0）不在这里返回，
+// 只记到bad里（窗口不动、每次写1个字符，不会越界），每轮装填后统一检查，省掉一个分支
+#define DECODE_STEP(w, pos, dst, out) do {                  \
+        unsigned int e_ = Lookup(tab, pair, w);             \
+        int l_ = (int)(e_ & 0xFF);                          \
+        bad |= l_ == 0;                                     \
+        (dst)[out] = (unsigned char)(e_ >> 8);              \
+        (dst)[(out) + 1] = (unsigned char)(e_ >> 16);       \
+        (out) += 1 + (e_ >> 24 & 1);                        \
+        (w) <<= l_;                                         \
+        (pos) += l_;                                        \
+    } while (0)
+
+// 快速路径的条件：输出还容得下一轮（per次查表、每次最多2个字符），码流还够装填一次64位
+#define CAN_FAST(pos, nbits, out, max) \
+    ((max) - (out) >= 2 * per && ((pos) >> 3) + 8 <= ((nbits) + 7) / 8 && (pos) + 64 <= (nbits))
+
+// 双字符表项会用到整整HUF_TABLE_BITS位，每次查表按这么多位算；一次装填后至少有57位可用
+static int LookupsPerRefill(const HufTable *t) {
+    return 57 / (t->maxlen > HUF_TABLE_BITS ? t->maxlen : HUF_TABLE_BITS);
+}
+
+// 收尾：从第pos位接着译到max_count个字符或码流用完，用单字符表逐个译，
+// 装填时超出码流的部分补0，每个码都检查是否越界；返回译出的总字符数，出错返回-1
+static long long DecodeTail(const HufTable *t, const unsigned char *src, long long nbits, long long pos,
+                            unsigned char *dst, long long out, long long max_count) {
+    const unsigned int *tab = t->entry;
+    long long bytes = (nbits + 7) / 8;
+
+    while (out < max_count && pos < nbits) {
+        unsigned long long window = 0;
+        unsigned int e;
+        int l;
+        for (int i = 0; i < 8; i++) {
+            long long b = (pos >> 3) + i;
+            window = window << 8 | (b < bytes ? src[b] : 0);
+        }
+        window <<= pos & 7;
+        e = Lookup(tab, tab, window);
+        l = (int)(e & 0xFF);
+        if (l == 0 || pos + l > nbits) return -1;
+        dst[out++] = (unsigned char)(e >> 8);
+        pos += l;
+    }
+    return out;
+}
+
+long long HufDecode(const HufTable *t, const unsigned char *src, long long nbits,
+                    unsigned char *dst, long long max_count) {
+    const unsigned int *tab = t->entry, *pair = t->entry + t->pair;
+    long long pos = 0, out = 0;
+    int per = LookupsPerRefill(t), bad = 0;
+
+    // 快速路径：装填一次64位窗口，固定查per次表（每次1~2个字符），窗口一直在寄存器里移位，
+    // 不必每个码都重新读内存；per在整块里不变，循环分支几乎不会预测失败
+    while (CAN_FAST(pos, nbits, out, max_count)) {
+        unsigned long long window = Load64BE(src + (pos >> 3)) << (pos & 7);
+        for (int k = 0; k < per; k++) DECODE_STEP(window, pos, dst, out);
+        if (bad) return -1;
+    }
+    return DecodeTail(t, src, nbits, pos, dst, out, max_count);
+}
+
+int HufDecode4(const HufTable *t, const unsigned char *const src[4], const long long nbits[4],
+               unsigned char *dst, const long long count[4]) {
+    const unsigned int *tab = t->entry, *pair = t->entry + t->pair;
+    const unsigned char *s0 = src[0], *s1 = src[1], *s2 = src[2], *s3 = src[3];
+    unsigned char *d0 = dst, *d1 = d0 + count[0], *d2 = d1 + count[1], *d3 = d2 + count[2];
+    long long p0 = 0, p1 = 0, p2 = 0, p3 = 0, o0 = 0, o1 = 0, o2 = 0, o3 = 0;
+    int per = LookupsPerRefill(t), bad = 0;
+
+    // 四路各用各的窗口和位置（都是局部变量，留在寄存器里），每一步轮流推进四路：
+    // 一路的查表在等内存时，另外三路的查表可以同时进行
+    while (CAN_FAST(p0, nbits[0], o0, count[0]) && CAN_FAST(p1, nbits[1], o1, count[1]) &&
+           CAN_FAST(p2, nbits[2], o2, count[2]) && CAN_FAST(p3, nbits[3], o3, count[3])) {
+        unsigned long long w0 = Load64BE(s0 + (p0 >> 3)) << (p0 & 7);
+        unsigned long long w1 = Load64BE(s1 + (p1 >> 3)) << (p1 & 7);
+        unsigned long long w2 = Load64BE(s2 + (p2 >> 3)) << (p2 & 7);
+        unsigned long long w3 = Load64BE(s3 + (p3 >> 3)) << (p3 & 7);
+        for (int k = 0; k < per; k++) {
+            DECODE_STEP(w0, p0, d0, o0);
+            DECODE_STEP(w1, p1, d1, o1);
+            DECODE_STEP(w2, p2, d2, o2);
+            DECODE_STEP(w3, p3, d3, o3);
+        }
+        if (bad) return 0;
+    }
+    // 各路剩下的部分分别收尾，每一路都必须恰好译出count[i]个字符
+    return DecodeTail(t, s0, nbits[0], p0, d0, o0, count[0]) == count[0] &&
+           DecodeTail(t, s1, nbits[1], p1, d1, o1, count[1]) == count[1] &&
+           DecodeTail(t, s2, nbits[2], p2, d2, o2, count[2]) == count[2] &&
+           DecodeTail(t, s3, nbits[3], p3, d3, o3, count[3]) == count[3];
+}
+
+// ====================== 按块压缩 ======================
+#define MULTI_MIN 1024      // 短于这个长度的块不值得分四路（多6字节跳转表和每路的补齐）
+
+static void Put16(unsigned char *p, unsigned int v) {
+    p[0] = (unsigned char)v;
+    p[1] = (unsigned char)(v >> 8);
+}
+
+static unsigned int Get16(const unsigned char *p) {
+    return p[0] | (unsigned int)p[1] << 8;
+}
+
+static unsigned int Get32(const unsigned char *p) {
+    return p[0] | (unsigned int)p[1] << 8 | (unsigned int)p[2] << 16 | (unsigned int)p[3] << 24;
+}
+
+size_t HufBound(size_t len) {
+    return len + 2 + 5 * HUF_SYMBOLS;     // 最坏情况退回原样存储；旧格式的频率表最多1282字节
+}
+
+// 写码长表（4位一项，连续的0做游程压缩），返回字节数
+static size_t PutLengths(unsigned char *dst, const int len[HUF_SYMBOLS]) {
+    size_t nib = 0;
+    for (int i = 0; i < HUF_SYMBOLS;) {
+        int v[2], k = 1;
+        if (len[i]) {
+            v[0] = len[i++];
+        } else {
+            int run = 1;
+            while (run < 16 && i + run < HUF_SYMBOLS && len[i + run] == 0) run++;
+            v[0] = 0;
+            v[1] = run - 1;
+            k = 2;
+            i += run;
+        }
+        for (int j = 0; j < k; j++, nib++) {
+            if (nib & 1) dst[nib >> 1] |= (unsigned char)v[j];
+            else dst[nib >> 1] = (unsigned char)(v[j] << 4);
+        }
+    }
+    return (nib + 1) / 2;
+}
+
+// 读码长表，返回占用的字节数，格式错误返回0
+static size_t GetLengths(const unsigned char *src, size_t src_len, int len[HUF_SYMBOLS]) {
+    size_t nib = 0;
+    for (int i = 0; i < HUF_SYMBOLS;) {
+        int v;
+        if ((nib >> 1) >= src_len) return 0;
+        v = nib & 1 ? src[nib >> 1] & 15 : src[nib >> 1] >> 4;
+        nib++;
+        if (v) {
+            len[i++] = v;
+            continue;
+        }
+        if ((nib >> 1) >= src_len) return 0;
+        v = (nib & 1 ? src[nib >> 1] & 15 : src[nib >> 1] >> 4) + 1;
+        nib++;
+        if (i + v > HUF_SYMBOLS) return 0;
+        while (v--) len[i++] = 0;
+    }
+    return (nib + 1) / 2;
+}
+
+// 用出现过的字符建树：叶子按字节值从小到大排列，ht[i].ch记录字节值，返回叶子数
+static int BuildFromFreq(Htreetype ht[], const unsigned int freq[HUF_SYMBOLS]) {
+    int cnt = 0;
+    for (int c = 0; c < HUF_SYMBOLS; c++) {
+        if (freq[c]) {
+            ht[cnt].ch = (char)c;
+            ht[cnt].weight = (int)freq[c];
+            cnt++;
+        }
+    }
+    HuffmanBuildHeap(ht, cnt);
+    return cnt;
+}
+
+// 从叶子回溯到根得到每个叶子的编码（左0右1），code的最低位是最后一位；返回最大码长
+// 只有一个叶子时码长为0（整块都是同一个字节，不需要码流）
+static int LeafCodes(const Htreetype ht[], int cnt, unsigned int code[], int len[]) {
+    int maxlen = 0;
+    for (int i = 0; i < cnt; i++) {
+        unsigned int c = 0;
+        int l = 0;
+        for (int j = i, p = ht[i].parent; p != -1; j = p, p = ht[p].parent) {
+            if (ht[p].Rchild == j && l < 32) c |= 1u << l;
+            l++;
+        }
+        code[i] = c;
+        len[i] = l;
+        if (l > maxlen) maxlen = l;
+    }
+    return maxlen;
+}
+
+// 由出现次数得到每个字节值的码长（不出现的为0），返回出现的字符数；
+// maxbits>0时码长不超过maxbits：哈夫曼树超长就改用package-merge求最优的限长码长
+static int BlockLengths(const unsigned int count[HUF_SYMBOLS], int maxbits, int sym_len[HUF_SYMBOLS]) {
+    unsigned int code[HUF_SYMBOLS], weight[HUF_SYMBOLS] = {0};
+    int codelen[HUF_SYMBOLS];
+    Htreetype ht[2 * HUF_SYMBOLS - 1];
+    int cnt = BuildFromFreq(ht, count);
+
+    memset(sym_len, 0, HUF_SYMBOLS * sizeof(int));
+    if (cnt == 1) {                 // 只有一个字符：记码长1，不需要码流
+        sym_len[(unsigned char)ht[0].ch] = 1;
+        return cnt;
+    }
+    if (LeafCodes(ht, cnt, code, codelen) > maxbits && maxbits > 0) {
+        for (int i = 0; i < cnt; i++) weight[i] = count[(unsigned char)ht[i].ch];
+        // cnt ≤ 256 ≤ 2^maxbits，返回0只可能是内存分配失败；不能带着超长的码长继续写块
+        if (!HufLimitLengths(weight, cnt, maxbits, codelen)) {
+            printf("错误！内存分配失败\n");
+            exit(1);
+        }
+    }
+    for (int i = 0; i < cnt; i++) sym_len[(unsigned char)ht[i].ch] = codelen[i];
+    return cnt;
+}
+
+unsigned long long HufCodedBits(const unsigned char *src, size_t len, int maxbits) {
+    unsigned int count[HUF_SYMBOLS];
+    int sym_len[HUF_SYMBOLS];
+    unsigned long long bits = 0;
+
+    ByteHistogram(src, len, count);
+    if (len == 0 || BlockLengths(count, maxbits, sym_len) == 1) return 0;
+    for (int c = 0; c < HUF_SYMBOLS; c++) bits += (unsigned long long)count[c] * (unsigned long long)sym_len[c];
+    return bits;
+}
+
+// tANS编码一块（出现次数已统计好），payload不超过limit字节才算成功，返回字节数，否则返回0；
+// 先按norm估算大小，明显放不下就不必真的编码
+static size_t EncodeAnsBlock(const unsigned char *src, size_t len, const unsigned int count[HUF_SYMBOLS],
+                             unsigned char *dst, size_t limit) {
+    short norm[HUF_SYMBOLS];
+    FseEncodeTable ct;
+    size_t head, body;
+
+    if (!FseNormalize(count, len, FSE_TABLE_LOG, norm)) return 0;
+    head = FseWriteHeader(dst, norm, FSE_TABLE_LOG);
+    if (head + (FseCodedBits(count, norm, FSE_TABLE_LOG) + 7) / 8 >= limit) return 0;
+    FseBuildEncodeTable(&ct, norm, FSE_TABLE_LOG);
+    body = FseEncode(&ct, src, len, dst + head, limit - head);
+    return body ? head + body : 0;
+}
+
+int HufEncodeBlock(const unsigned char *src, size_t len, unsigned char *dst, size_t *dst_len,
+                   int maxbits, int streams, int engine) {
+    unsigned int count[HUF_SYMBOLS], sym_code[HUF_SYMBOLS];
+    int sym_len[HUF_SYMBOLS];
+    unsigned long long bits = 0;
+    size_t head, seg, size;
+    int cnt, multi;
+    unsigned char *p;
+    BitWriter bw;
+
+    if (maxbits <= 0 || maxbits > HUF_MAXBIT) maxbits = HUF_MAXBIT;
+    if (maxbits < HUF_MINBIT) maxbits = HUF_MINBIT;
+    ByteHistogram(src, len, count);
+    cnt = BlockLengths(count, maxbits, sym_len);
+    // 码长确定后编码按码长规范分配；总位数直接由出现次数×码长得到，不必再扫一遍数据
+    if (cnt > 1) {
+        for (int c = 0; c < HUF_SYMBOLS; c++) bits += (unsigned long long)count[c] * (unsigned long long)sym_len[c];
+    }
+    HufCanonicalCodes(sym_len, HUF_SYMBOLS, sym_code);
+
+    head = PutLengths(dst, sym_len);
+    multi = streams == 4 && cnt > 1 && len >= MULTI_MIN;
+    if (multi) head += 6;
+    size = head + (bits + 7) / 8 + (multi ? 3 : 0);
+    // tANS：AUTO时要严格比哈夫曼小才用（一样大仍用哈夫曼，解码更快）；两者都要比原样存储小。
+    // size对四路多算了最多3字节的补齐，实际的哈夫曼块不小于size-3，所以四路时和size-3比。
+    // 没用上就重写被覆盖的码长表
+    if (engine != HUF_ENGINE_HUF && cnt > 1) {
+        size_t huf = size - (multi ? 3 : 0);
+        size_t ans = EncodeAnsBlock(src, len, count, dst, engine == HUF_ENGINE_AUTO && huf < len ? huf - 1 : len);
+        if (ans) {
+            *dst_len = ans;
+            return HUF_BLOCK_ANS;
+        }
+        PutLengths(dst, sym_len);
+    }
+    if (len == 0 || size >= len) {     // 压不小：原样存储
+        memcpy(dst, src, len);
+        *dst_len = len;
+        return HUF_BLOCK_RAW;
+    }
+    if (!multi) {
+        InitBits(&bw, dst + head);
+        if (cnt > 1) {
+            for (size_t i = 0; i < len; i++) PutBits(&bw, sym_code[src[i]], sym_len[src[i]]);
+        }
+        *dst_len = (size_t)(FlushBits(&bw) - dst);
+        return HUF_BLOCK_CANON;
+    }
+
+    // 四路：块均分成四段，各段单独成一路码流（各自补齐到字节），前三路的字节数记在跳转表里
+    seg = (len + 3) / 4;
+    p = dst + head;
+    for (int k = 0; k < 4; k++) {
+        size_t from = k * seg, to = from + seg < len ? from + seg : len;
+        unsigned char *end;
+        InitBits(&bw, p);
+        for (size_t i = from; i < to; i++) PutBits(&bw, sym_code[src[i]], sym_len[src[i]]);
+        end = FlushBits(&bw);
+        if (k < 3) Put16(dst + head - 6 + 2 * k, (unsigned int)(end - p));
+        p = end;
+    }
+    *dst_len = (size_t)(p - dst);
+    return HUF_BLOCK_CANON4;
+}
+
+// 由各字符的编码建译码表，把码流查表译成raw_len个字节
+static int DecodeStream(const unsigned int code[], const int len[], const unsigned char sym[], int cnt,
+                        const unsigned char *src, size_t src_len, unsigned char *dst, size_t raw_len) {
+    HufTable tab;
+    long long got;
+
+    if (!HufBuildTable(&tab, code, len, sym, cnt)) return 0;
+    got = HufDecode(&tab, src, (long long)src_len * 8, dst, (long long)raw_len);
+    HufFreeTable(&tab);
+    return got == (long long)raw_len;
+}
+
+// 旧格式：按频率重建同一棵树，由树得到各字符的编码
+static int DecodeFreqBlock(const unsigned char *src, size_t src_len, unsigned char *dst, size_t raw_len) {
+    unsigned int freq[HUF_SYMBOLS] = {0}, code[HUF_SYMBOLS];
+    int len[HUF_SYMBOLS];
+    unsigned char sym[HUF_SYMBOLS];
+    Htreetype ht[2 * HUF_SYMBOLS - 1];
+    size_t head;
+    int cnt;
+
+    if (src_len < 2) return 0;
+    cnt = (int)Get16(src);
+    head = 2 + 5 * (size_t)cnt;
+    if (cnt < 1 || cnt > HUF_SYMBOLS || src_len < head) return 0;
+    for (int i = 0; i < cnt; i++) {
+        freq[src[2 + 5 * i]] = Get32(src + 3 + 5 * i);
+        if (freq[src[2 + 5 * i]] == 0 || freq[src[2 + 5 * i]] > HUF_BLOCK_SIZE) return 0;
+    }
+    if (BuildFromFreq(ht, freq) != cnt) return 0;       // 字节值重复
+    if (cnt == 1) {
+        memset(dst, (unsigned char)ht[0].ch, raw_len);
+        return 1;
+    }
+    LeafCodes(ht, cnt, code, len);
+    for (int i = 0; i < cnt; i++) sym[i] = (unsigned char)ht[i].ch;
+    return DecodeStream(code, len, sym, cnt, src + head, src_len - head, dst, raw_len);
+}
+
+// 规范编码：读码长表，按码长重新分配编码；multi表示四路码流
+static int DecodeCanonBlock(const unsigned char *src, size_t src_len, unsigned char *dst, size_t raw_len,
+                            int multi) {
+    int sym_len[HUF_SYMBOLS], len[HUF_SYMBOLS];
+    unsigned int sym_code[HUF_SYMBOLS], code[HUF_SYMBOLS];
+    unsigned char sym[HUF_SYMBOLS];
+    size_t head = GetLengths(src, src_len, sym_len);
+    int cnt = 0;
+
+    if (head == 0 || !HufCanonicalCodes(sym_len, HUF_SYMBOLS, sym_code)) return 0;
+    for (int c = 0; c < HUF_SYMBOLS; c++) {
+        if (sym_len[c]) {
+            code[cnt] = sym_code[c];
+            len[cnt] = sym_len[c];
+            sym[cnt++] = (unsigned char)c;
+        }
+    }
+    if (cnt == 0) return 0;
+    if (cnt == 1 && !multi) {
+        memset(dst, sym[0], raw_len);
+        return head == src_len;
+    }
+    if (!multi) return DecodeStream(code, len, sym, cnt, src + head, src_len - head, dst, raw_len);
+
+    // 四路：由跳转表找到各路码流的起点，四段的长度由raw_len算出
+    {
+        const unsigned char *start[4];
+        long long nbits[4], count[4];
+        size_t seg = (raw_len + 3) / 4, pos = head + 6;
+        HufTable tab;
+        int ok;
+
+        if (src_len < pos) return 0;
+        for (int k = 0; k < 4; k++) {
+            size_t bytes = k < 3 ? Get16(src + head + 2 * k) : src_len - pos;
+            if (bytes > src_len - pos) return 0;
+            start[k] = src + pos;
+            nbits[k] = (long long)bytes * 8;
+            count[k] = (long long)(k * seg >= raw_len ? 0 : (k + 1) * seg <= raw_len ? seg : raw_len - k * seg);
+            pos += bytes;
+        }
+        if (!HufBuildTable(&tab, code, len, sym, cnt)) return 0;
+        ok = HufDecode4(&tab, start, nbits, dst, count);
+        HufFreeTable(&tab);
+        return ok;
+    }
+}
+
+static int DecodeAnsBlock(const unsigned char *src, size_t src_len, unsigned char *dst, size_t raw_len) {
+    short norm[HUF_SYMBOLS];
+    FseDecodeEntry dt[1 << FSE_MAX_LOG];
+    int tablelog;
+    size_t head = FseReadHeader(src, src_len, norm, &tablelog);
+
+    if (head == 0) return 0;
+    FseBuildDecodeTable(dt, norm, tablelog);
+    return FseDecode(dt, tablelog, src + head, src_len - head, dst, raw_len);
+}
+
+int HufDecodeBlock(int type, const unsigned char *src, size_t src_len, unsigned char *dst, size_t raw_len) {
+    switch (type) {
+    case HUF_BLOCK_RAW:
+        if (src_len != raw_len) return 0;
+        memcpy(dst, src, raw_len);
+        return 1;
+    case HUF_BLOCK_FREQ:
+        return DecodeFreqBlock(src, src_len, dst, raw_len);
+    case HUF_BLOCK_CANON:
+        return DecodeCanonBlock(src, src_len, dst, raw_len, 0);
+    case HUF_BLOCK_CANON4:
+        return DecodeCanonBlock(src, src_len, dst, raw_len, 1);
+    case HUF_BLOCK_ANS:
+        return DecodeAnsBlock(src, src_len, dst, raw_len);
+    default:
+        return 0;
+    }
+}
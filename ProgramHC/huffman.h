@@ -0,0 +1,147 @@
+#ifndef HUFFMAN_H
+#define HUFFMAN_H
+
+#include <stddef.h>
+
+// 哈夫曼树的公共部分：编码演示程序（main.c）和文件压缩程序共用
+
+// 哈夫曼树节点结构定义
+// 数组存储：0~cnt-1是叶子，cnt~2cnt-2是依次合并出的非叶子节点，最后一个是根
+typedef struct {
+    char ch;         // 节点对应字符：仅叶子节点有效
+    int weight;      // 节点权重：叶子节点=字符出现频率，非叶子节点=左右子节点权重之和
+    int parent;      // 父节点索引（-1表示无父节点）
+    int Lchild;      // 左孩子索引（-1表示无左孩子）
+    int Rchild;      // 右孩子索引（-1表示无右孩子）
+} Htreetype;
+
+// 三种建树方法，调用前填好ht[0..cnt-1].weight，ht至少要有2cnt-1个元素。
+// 每次都取(权重, 下标)字典序最小的两个节点，权重相同时下标小的优先、且较小者做左孩子，
+// 所以三种方法得到的ht[]完全相同（与原来逐个扫描的结果也相同）。
+void HuffmanBuildScan(Htreetype ht[], int cnt);    // 原方法：每次扫描全部节点，O(n²)
+void HuffmanBuildHeap(Htreetype ht[], int cnt);    // 二叉堆，O(n log n)
+int HuffmanBuildSorted(Htreetype ht[], int cnt);   // 双队列，O(n)；要求叶子权重不降，否则返回0
+
+// 限长码长（package-merge）：求weight[0..cnt-1]的码长，都不超过maxbits且Σ权重×码长最小，
+// O(cnt·maxbits)。要求cnt ≤ 2^maxbits，否则返回0；只有一个字符时码长为1
+int HufLimitLengths(const unsigned int weight[], int cnt, int maxbits, int len[]);
+
+// ---------- 位写入器：64位累加器，凑满32位就按大端整字写出 ----------
+// 码流高位在前：先写的位在前一个字节的高位。每次写入的码长不超过32位。
+typedef struct {
+    unsigned char *p;           // 下一个输出字节
+    unsigned long long acc;     // 低n位是还没写出的位
+    int n;
+} BitWriter;
+
+static inline void InitBits(BitWriter *bw, unsigned char *out) {
+    bw->p = out;
+    bw->acc = 0;
+    bw->n = 0;
+}
+
+static inline void PutBits(BitWriter *bw, unsigned int code, int len) {
+    bw->acc = bw->acc << len | code;
+    bw->n += len;
+    if (bw->n >= 32) {
+        unsigned int w;
+        bw->n -= 32;
+        w = (unsigned int)(bw->acc >> bw->n);
+        bw->p[0] = (unsigned char)(w >> 24);
+        bw->p[1] = (unsigned char)(w >> 16);
+        bw->p[2] = (unsigned char)(w >> 8);
+        bw->p[3] = (unsigned char)w;
+        bw->p += 4;
+    }
+}
+
+// 写出剩下不足32位的部分（最后一个字节低位补0），返回结束位置
+static inline unsigned char *FlushBits(BitWriter *bw) {
+    while (bw->n > 0) {
+        bw->n -= 8;
+        *bw->p++ = (unsigned char)(bw->n >= 0 ? bw->acc >> bw->n : bw->acc << -bw->n);
+    }
+    bw->n = 0;
+    return bw->p;
+}
+
+// ---------- 查表译码：一次取HUF_TABLE_BITS位，一次查表得到字符和码长 ----------
+// 码长不超过HUF_TABLE_BITS的编码直接落在主表里（前缀相同的各项都填同一个字符）；
+// 更长的编码按前HUF_TABLE_BITS位分组，主表项指向该组的二级表，再查一次。
+// 另有一张“双字符”主表：HUF_TABLE_BITS位里如果恰好容得下两个完整的编码，一次查表译出两个字符。
+// 表项：码长（两个字符时是总长）| 字符1<<8 | 字符2<<16 | (字符数-1)<<24，码长0表示非法码；
+//       二级表指针 = 1<<31 | 偏移<<5 | 二级表位数
+#define HUF_TABLE_BITS 11
+#define HUF_DECODE_MAXLEN 28        // 装填一次至少有57位可用，码长不能超过这个值
+
+typedef struct {
+    unsigned int *entry;    // 单字符主表（1<<HUF_TABLE_BITS项）、各个二级表、双字符主表
+    int pair;               // 双字符主表的偏移
+    int maxlen;             // 最长码长
+} HufTable;
+
+// 规范哈夫曼编码：只由码长决定编码。按(码长, 下标)从小到大依次分配，同一码长的编码连续递增，
+// 所以编码端只需传码长，解码端就能重建出同一套编码。len[i]为0表示该字符不出现（不分配编码）；
+// 码长超出HUF_DECODE_MAXLEN或不满足前缀码条件（Kraft和大于1）时返回0
+int HufCanonicalCodes(const int len[], int cnt, unsigned int code[]);
+
+// 由各字符的(编码, 码长)建表（编码不必是规范编码），成功返回1
+int HufBuildTable(HufTable *t, const unsigned int code[], const int len[], const unsigned char sym[], int cnt);
+void HufFreeTable(HufTable *t);
+// 从码流（高位在前，共nbits位）译出字符写入dst，最多max_count个、或码流用完为止；
+// 返回译出的字符数，遇到非法码或码流越界返回-1
+long long HufDecode(const HufTable *t, const unsigned char *src, long long nbits,
+                    unsigned char *dst, long long max_count);
+// 四路码流交错译码：第i路码流src[i]（nbits[i]位）恰好译出count[i]个字符，依次写在dst的第i段。
+// 四路在同一个循环里轮流查表，彼此没有数据依赖，CPU可以同时推进；成功返回1，出错返回0
+int HufDecode4(const HufTable *t, const unsigned char *const src[4], const long long nbits[4],
+               unsigned char *dst, const long long count[4]);
+
+// ---------- 按块压缩（文件压缩程序huffzip.c使用） ----------
+// 每块独立编码，块内容（payload）的格式由块类型决定：
+//   HUF_BLOCK_RAW  原样存储
+//   HUF_BLOCK_FREQ 频率表 + 哈夫曼码流（旧格式，只解码不再生成）：
+//       u16 出现的字符数k，k×(u8 字符, u32 频率)，然后是码流（高位在前）
+//       解码端用同样的频率和HuffmanBuildHeap重建出同一棵树
+//   HUF_BLOCK_CANON 码长表 + 规范哈夫曼码流：
+//       256个字符的码长，每个占4位（高半字节在前），0表示不出现；
+//       连续的0压缩成两个半字节：0、连续个数-1（一次最多16个），码长表末尾不足一字节补0，
+//       然后是码流（高位在前）。只有一个字符出现时没有码流
+//   HUF_BLOCK_CANON4 四路码流：码长表（同上），u16×3 前三路码流的字节数（跳转表），然后是四路码流。
+//       原始数据均分成四段（每段(len+3)/4字节，最后一段是剩下的），每段各自编码、各自补齐到字节；
+//       解码时四路交错推进（HufDecode4），打破单路码流逐个查表的依赖链
+//   HUF_BLOCK_ANS  tANS（见fse.h）：norm表（FseWriteHeader），然后是码流。
+//       统计和分块与哈夫曼共用，哈夫曼整数位码长吃亏较多时（如某个字节占一半以上）压缩率更好
+// 多字节整数一律小端存放
+#define HUF_BLOCK_SIZE (1 << 17)    // 每块最多128KB原始数据（四路时每路最多32K字节×15位，u16放得下）
+#define HUF_MAXBIT 15               // 编码的最大长度（码长表每项4位），哈夫曼树超长时改用限长码长
+#define HUF_MINBIT 8                // 码长上限至少8位，才容得下256个字节值
+#define HUF_SYMBOLS 256
+
+enum {
+    HUF_BLOCK_RAW = 0,
+    HUF_BLOCK_FREQ = 1,
+    HUF_BLOCK_CANON = 2,
+    HUF_BLOCK_CANON4 = 3,
+    HUF_BLOCK_ANS = 4
+};
+
+// 熵编码引擎：每块按engine选择
+enum {
+    HUF_ENGINE_HUF = 0,         // 只用哈夫曼
+    HUF_ENGINE_ANS = 1,         // 优先用tANS（不比原样存储小时仍退回哈夫曼/原样）
+    HUF_ENGINE_AUTO = 2         // 每块估算两者的大小，取小的
+};
+
+size_t HufBound(size_t len);    // 一块payload的最大字节数
+// 压缩一块：写payload到dst，*dst_len返回字节数，返回块类型（不划算时退回HUF_BLOCK_RAW）
+// maxbits是码长上限（HUF_MINBIT~HUF_MAXBIT，0表示HUF_MAXBIT）；不超过HUF_TABLE_BITS时译码表只有一级
+// streams是码流路数：1或4（4路时太短的块仍用1路）；engine是HUF_ENGINE_*
+int HufEncodeBlock(const unsigned char *src, size_t len, unsigned char *dst, size_t *dst_len,
+                   int maxbits, int streams, int engine);
+// 一块用码长上限为maxbits的码编码后码流的位数（不含码长表），maxbits=0表示不限长的哈夫曼码
+unsigned long long HufCodedBits(const unsigned char *src, size_t len, int maxbits);
+// 解压一块：raw_len是原始长度，成功返回1，数据损坏返回0
+int HufDecodeBlock(int type, const unsigned char *src, size_t src_len, unsigned char *dst, size_t raw_len);
+
+#endif // HUFFMAN_H
@@ -0,0 +1,847 @@
+#define _FILE_OFFSET_BITS 64     // 32位系统上fseeko也用64位偏移（多GB的文件）
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include "../utf8support.h"
+#include "huffman.h"
+#include "adaptive.h"
+#include "fse.h"
+#include "../bytehist.h"
+#ifdef _WIN32
+#include <io.h>
+#include <fcntl.h>
+#define FSEEK64 _fseeki64
+#else
+#include <unistd.h>
+#define FSEEK64 fseeko
+#endif
+
+// 哈夫曼文件压缩程序（任意文件，256个字节值）
+// 文件格式：魔数"HUF2"，然后是若干块：
+//   u8 块类型，u32 原始长度，u32 payload长度，payload（格式见huffman.h）
+// 最后是结束块和块索引：
+//   u8 0xFF，u32 块数k，u32 索引字节数16(k+1)，
+//   (k+1)×(u64 块在文件中的偏移, u64 块的数据在原文件中的偏移)，最后一项是结束块的位置和原文件总长度；
+//   u64 结束块在文件中的偏移，"HIDX"（文件最后12字节，随机访问时由此找到索引）
+// 旧格式"HUF1"没有结束块和索引，仍可顺序解压。
+// 各块互相独立：压缩时一批块交给线程池并行编码，再按原顺序写出；解压同样按批并行解码；
+// 有了索引，取原文件的任意一段只需解码它所在的几块（r命令）。
+// 一次只读入一批块，内存占用与文件大小无关，顺序压缩/解压的输入输出都可以是管道（用"-"表示）
+// -a 选项改用自适应哈夫曼（见adaptive.h）：魔数"HUFA"后面就是一条码流，边读边编码，
+// 不分块、不统计、没有索引，适合长度未知的流；但逐位走树，比静态的两遍编码慢得多（t命令可比较）
+#define ZIP_MAGIC "HUF2"
+#define ZIP_MAGIC_V1 "HUF1"
+#define ZIP_MAGIC_ADAPTIVE "HUFA"
+#define ADAPTIVE_CHUNK 4096     // 自适应压缩每次读入的字节数（最坏每字节输出ADH_MAX_BITS位）
+#define INDEX_MAGIC "HIDX"
+#define ZIP_END 0xFF            // 结束块的类型
+#define BLOCK_HEAD 9
+#define TRAILER 12
+#define MAX_THREADS 64
+#define BATCH_PER_THREAD 4      // 每批块数 = 线程数×4，各线程分到的活更均匀
+
+static double NowMs(void) {
+#ifdef _WIN32
+    LARGE_INTEGER freq, now;
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&now);
+    return (double)now.QuadPart * 1000.0 / (double)freq.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+#endif
+}
+
+static int CpuCount(void) {
+#ifdef _WIN32
+    SYSTEM_INFO si;
+    GetSystemInfo(&si);
+    return (int)si.dwNumberOfProcessors;
+#else
+    long k = sysconf(_SC_NPROCESSORS_ONLN);
+    return k > 0 ? (int)k : 1;
+#endif
+}
+
+static void Put32(unsigned char *p, unsigned int v) {
+    p[0] = (unsigned char)v;
+    p[1] = (unsigned char)(v >> 8);
+    p[2] = (unsigned char)(v >> 16);
+    p[3] = (unsigned char)(v >> 24);
+}
+
+static unsigned int Get32(const unsigned char *p) {
+    return p[0] | (unsigned int)p[1] << 8 | (unsigned int)p[2] << 16 | (unsigned int)p[3] << 24;
+}
+
+static void Put64(unsigned char *p, unsigned long long v) {
+    Put32(p, (unsigned int)v);
+    Put32(p + 4, (unsigned int)(v >> 32));
+}
+
+static unsigned long long Get64(const unsigned char *p) {
+    return Get32(p) | (unsigned long long)Get32(p + 4) << 32;
+}
+
+// 打开文件，"-"表示标准输入/输出（切换成二进制模式）
+static FILE *OpenFile(const char *path, const char *mode) {
+    if (strcmp(path, "-") == 0) {
+        FILE *fp = mode[0] == 'r' ? stdin : stdout;
+#ifdef _WIN32
+        _setmode(_fileno(fp), _O_BINARY);
+#endif
+        return fp;
+    }
+    return fopen(path, mode);
+}
+
+static void *Alloc(size_t size) {
+    void *p = malloc(size);
+    if (p == NULL) {
+        fprintf(stderr, "错误！内存分配失败\n");
+        exit(1);
+    }
+    return p;
+}
+
+// 统计信息输出到stderr，避免混进标准输出上的数据
+static void Report(const char *what, unsigned long long raw, unsigned long long packed, double ms) {
+    fprintf(stderr, "%s：%llu -> %llu 字节（%.2f%%），%.1f ms，%.1f MB/s\n", what, raw, packed,
+            raw ? 100.0 * packed / raw : 0.0, ms, ms > 0 ? raw / (ms / 1000.0) / 1048576.0 : 0.0);
+}
+
+// ---------- 线程池：主线程把一批任务job(ctx, 0..count-1)交给工作线程，自己也参与，做完才返回 ----------
+typedef void (*PoolJob)(void *ctx, int i);
+
+typedef struct {
+    pthread_t tid[MAX_THREADS];
+    int threads;                // 包括调用PoolRun的主线程
+    pthread_mutex_t lock;
+    pthread_cond_t wake;        // 来了新的一批任务，或者要退出
+    pthread_cond_t done;        // 这一批全部做完
+    PoolJob job;
+    void *ctx;
+    int next, count, finished;  // 下一个要领的任务、本批任务数、已做完的任务数
+    int quit;
+} Pool;
+
+// 领一个任务来做，没有任务返回0（调用时持有锁，做任务期间放开）
+static int PoolStep(Pool *p) {
+    int i;
+    if (p->next >= p->count) return 0;
+    i = p->next++;
+    pthread_mutex_unlock(&p->lock);
+    p->job(p->ctx, i);
+    pthread_mutex_lock(&p->lock);
+    if (++p->finished == p->count) pthread_cond_signal(&p->done);
+    return 1;
+}
+
+static void *PoolWorker(void *arg) {
+    Pool *p = (Pool *)arg;
+    pthread_mutex_lock(&p->lock);
+    while (!p->quit) {
+        if (!PoolStep(p)) pthread_cond_wait(&p->wake, &p->lock);
+    }
+    pthread_mutex_unlock(&p->lock);
+    return NULL;
+}
+
+static void PoolInit(Pool *p, int threads) {
+    if (threads < 1) threads = 1;
+    if (threads > MAX_THREADS) threads = MAX_THREADS;
+    p->threads = threads;
+    p->job = NULL;
+    p->ctx = NULL;
+    p->next = p->count = p->finished = 0;
+    p->quit = 0;
+    pthread_mutex_init(&p->lock, NULL);
+    pthread_cond_init(&p->wake, NULL);
+    pthread_cond_init(&p->done, NULL);
+    for (int i = 1; i < threads; i++) {
+        // 创建失败就只用已经启动的线程（主线程也会领任务，活总能做完），PoolFree只join这些
+        if (pthread_create(&p->tid[i], NULL, PoolWorker, p) != 0) {
+            p->threads = i;
+            break;
+        }
+    }
+}
+
+static void PoolRun(Pool *p, PoolJob job, void *ctx, int count) {
+    pthread_mutex_lock(&p->lock);
+    p->job = job;
+    p->ctx = ctx;
+    p->next = 0;
+    p->count = count;
+    p->finished = 0;
+    pthread_cond_broadcast(&p->wake);
+    while (PoolStep(p)) {
+    }
+    while (p->finished < p->count) pthread_cond_wait(&p->done, &p->lock);
+    p->next = p->count = 0;
+    pthread_mutex_unlock(&p->lock);
+}
+
+static void PoolFree(Pool *p) {
+    pthread_mutex_lock(&p->lock);
+    p->quit = 1;
+    pthread_cond_broadcast(&p->wake);
+    pthread_mutex_unlock(&p->lock);
+    for (int i = 1; i < p->threads; i++) pthread_join(p->tid[i], NULL);
+    pthread_mutex_destroy(&p->lock);
+    pthread_cond_destroy(&p->wake);
+    pthread_cond_destroy(&p->done);
+}
+
+// ---------- 一批块：每块一个槽，编码/解码任务各管一个槽 ----------
+typedef struct {
+    unsigned char *raw;         // 原始数据
+    unsigned char *enc;         // 块头（BLOCK_HEAD字节）+ payload
+    size_t raw_len, enc_len;    // enc_len是payload的长度
+    int type, ok;
+} Slot;
+
+typedef struct {
+    Slot *slot;
+    int size;
+    int maxbits, streams, engine;
+} Batch;
+
+static void NewBatch(Batch *b, int size, int maxbits, int streams, int engine) {
+    b->slot = (Slot *)Alloc(size * sizeof(Slot));
+    b->size = size;
+    b->maxbits = maxbits;
+    b->streams = streams;
+    b->engine = engine;
+    for (int i = 0; i < size; i++) {
+        b->slot[i].raw = (unsigned char *)Alloc(HUF_BLOCK_SIZE);
+        b->slot[i].enc = (unsigned char *)Alloc(BLOCK_HEAD + HufBound(HUF_BLOCK_SIZE));
+    }
+}
+
+static void FreeBatch(Batch *b) {
+    for (int i = 0; i < b->size; i++) {
+        free(b->slot[i].raw);
+        free(b->slot[i].enc);
+    }
+    free(b->slot);
+}
+
+static void EncodeJob(void *ctx, int i) {
+    Batch *b = (Batch *)ctx;
+    Slot *s = &b->slot[i];
+    s->type = HufEncodeBlock(s->raw, s->raw_len, s->enc + BLOCK_HEAD, &s->enc_len, b->maxbits, b->streams,
+                             b->engine);
+    s->enc[0] = (unsigned char)s->type;
+    Put32(s->enc + 1, (unsigned int)s->raw_len);
+    Put32(s->enc + 5, (unsigned int)s->enc_len);
+}
+
+static void DecodeJob(void *ctx, int i) {
+    Slot *s = &((Batch *)ctx)->slot[i];
+    s->ok = HufDecodeBlock(s->type, s->enc + BLOCK_HEAD, s->enc_len, s->raw, s->raw_len);
+}
+
+// 压缩：一批一批读入，线程池并行编码，按原顺序写出，最后写块索引
+int Compress(FILE *in, FILE *out, int maxbits, int streams, int engine, int threads) {
+    Pool pool;
+    Batch b;
+    unsigned long long raw = 0, packed = 4, *index = NULL;     // index：每块两项（文件偏移，原始偏移）
+    size_t blocks = 0, cap = 0, ans = 0;
+    unsigned char head[BLOCK_HEAD], tail[16];
+    char label[32];
+    int k, ret = 0;
+    double t0 = NowMs();
+
+    PoolInit(&pool, threads);
+    NewBatch(&b, pool.threads * BATCH_PER_THREAD, maxbits, streams, engine);
+    fwrite(ZIP_MAGIC, 1, 4, out);
+    do {
+        for (k = 0; k < b.size; k++) {
+            b.slot[k].raw_len = fread(b.slot[k].raw, 1, HUF_BLOCK_SIZE, in);
+            if (b.slot[k].raw_len == 0) break;
+        }
+        PoolRun(&pool, EncodeJob, &b, k);
+        for (int i = 0; i < k && ret == 0; i++) {
+            Slot *s = &b.slot[i];
+            if (blocks + 1 >= cap) {
+                unsigned long long *grown;
+                cap = cap ? cap * 2 : 1024;
+                grown = (unsigned long long *)realloc(index, cap * 2 * sizeof(unsigned long long));
+                if (grown == NULL) {
+                    fprintf(stderr, "错误！内存分配失败\n");
+                    exit(1);
+                }
+                index = grown;
+            }
+            index[2 * blocks] = packed;
+            index[2 * blocks + 1] = raw;
+            blocks++;
+            if (fwrite(s->enc, 1, BLOCK_HEAD + s->enc_len, out) != BLOCK_HEAD + s->enc_len) {
+                fprintf(stderr, "写入失败\n");
+                ret = 1;
+            }
+            raw += s->raw_len;
+            packed += BLOCK_HEAD + s->enc_len;
+            ans += s->type == HUF_BLOCK_ANS;
+        }
+    } while (k == b.size && ret == 0);
+
+    // 结束块 + 索引（多一项：结束块自己的位置和原文件总长度）+ 末尾12字节
+    if (ret == 0) {
+        unsigned long long end = packed;
+        head[0] = ZIP_END;
+        Put32(head + 1, (unsigned int)blocks);
+        Put32(head + 5, (unsigned int)(16 * (blocks + 1)));
+        fwrite(head, 1, BLOCK_HEAD, out);
+        for (size_t i = 0; i <= blocks; i++) {
+            Put64(tail, i < blocks ? index[2 * i] : end);
+            Put64(tail + 8, i < blocks ? index[2 * i + 1] : raw);
+            fwrite(tail, 1, 16, out);
+        }
+        Put64(tail, end);
+        memcpy(tail + 8, INDEX_MAGIC, 4);
+        if (fwrite(tail, 1, TRAILER, out) != TRAILER) {
+            fprintf(stderr, "写入失败\n");
+            ret = 1;
+        }
+        packed += BLOCK_HEAD + 16 * (blocks + 1) + TRAILER;
+    }
+    fflush(out);
+    snprintf(label, sizeof(label), "压缩（%d线程）", pool.threads);
+    if (ret == 0) Report(label, raw, packed, NowMs() - t0);
+    if (ret == 0 && engine != HUF_ENGINE_HUF) fprintf(stderr, "%zu块中%zu块用tANS\n", blocks, ans);
+    FreeBatch(&b);
+    PoolFree(&pool);
+    free(index);
+    return ret;
+}
+
+// 读一块的头和payload（payload放在enc+BLOCK_HEAD），成功返回1；
+// 读到结束块或文件结束返回0（*type分别为ZIP_END和-1），格式错误返回-1
+static int ReadBlock(FILE *in, int *type, size_t *raw_len, unsigned char *enc, size_t *enc_len) {
+    size_t got = fread(enc, 1, BLOCK_HEAD, in);
+    *type = -1;
+    if (got == 0) return 0;
+    if (got != BLOCK_HEAD) return -1;
+    *type = enc[0];
+    if (*type == ZIP_END) return 0;
+    *raw_len = Get32(enc + 1);
+    *enc_len = Get32(enc + 5);
+    if (*raw_len > HUF_BLOCK_SIZE || *enc_len > HufBound(HUF_BLOCK_SIZE)) return -1;
+    return fread(enc + BLOCK_HEAD, 1, *enc_len, in) == *enc_len ? 1 : -1;
+}
+
+// 检查魔数，返回格式版本（1或2，自适应格式返回3），不认识返回0
+static int CheckMagic(FILE *in) {
+    char magic[4];
+    if (fread(magic, 1, 4, in) == 4) {
+        if (memcmp(magic, ZIP_MAGIC, 4) == 0) return 2;
+        if (memcmp(magic, ZIP_MAGIC_V1, 4) == 0) return 1;
+        if (memcmp(magic, ZIP_MAGIC_ADAPTIVE, 4) == 0) return 3;
+    }
+    fprintf(stderr, "不是HUF1/HUF2/HUFA格式的文件\n");
+    return 0;
+}
+
+// 自适应压缩：只扫一遍，每读入一段就编码并写出已凑满的字节（不足一字节的位留在bw里）
+int CompressAdaptive(FILE *in, FILE *out) {
+    unsigned char *buf = (unsigned char *)Alloc(ADAPTIVE_CHUNK);
+    unsigned char *enc = (unsigned char *)Alloc((size_t)ADAPTIVE_CHUNK * ADH_MAX_BITS / 8 + 8);
+    AdhTree *t = (AdhTree *)Alloc(sizeof(AdhTree));
+    unsigned long long raw = 0, packed = 4;
+    BitWriter bw;
+    size_t len;
+    double t0 = NowMs();
+
+    AdhInit(t);
+    InitBits(&bw, enc);
+    fwrite(ZIP_MAGIC_ADAPTIVE, 1, 4, out);
+    while ((len = fread(buf, 1, ADAPTIVE_CHUNK, in)) > 0) {
+        AdhEncode(t, &bw, buf, len);
+        fwrite(enc, 1, (size_t)(bw.p - enc), out);
+        packed += (unsigned long long)(bw.p - enc);
+        bw.p = enc;
+        raw += len;
+    }
+    AdhEncodeEnd(t, &bw);
+    FlushBits(&bw);
+    fwrite(enc, 1, (size_t)(bw.p - enc), out);
+    packed += (unsigned long long)(bw.p - enc);
+    fflush(out);
+    Report("自适应压缩", raw, packed, NowMs() - t0);
+    free(buf);
+    free(enc);
+    free(t);
+    return 0;
+}
+
+// 自适应解压（魔数已读过）：译到结束符为止
+static int DecompressAdaptive(FILE *in, FILE *out) {
+    unsigned char *dec = (unsigned char *)Alloc(HUF_BLOCK_SIZE);
+    AdhTree *t = (AdhTree *)Alloc(sizeof(AdhTree));
+    AdhReader *r = (AdhReader *)Alloc(sizeof(AdhReader));
+    unsigned long long raw = 0;
+    long long got;
+    int eof = 0;
+    double t0 = NowMs();
+
+    AdhInit(t);
+    AdhInitReader(r, in, NULL, 0);
+    while (!eof && (got = AdhDecode(t, r, dec, HUF_BLOCK_SIZE, &eof)) >= 0) {
+        fwrite(dec, 1, (size_t)got, out);
+        raw += (unsigned long long)got;
+    }
+    fflush(out);
+    if (eof) Report("自适应解压", raw, raw, NowMs() - t0);
+    else fprintf(stderr, "数据损坏或不完整\n");
+    free(dec);
+    free(t);
+    free(r);
+    return eof ? 0 : 1;
+}
+
+// 解码一批（k块）并按顺序写出原始数据中[from, to)这一段（r命令只要其中一部分），出错返回0
+static int DecodeBatch(Pool *pool, Batch *b, int k, FILE *out, unsigned long long first_raw,
+                       unsigned long long from, unsigned long long to) {
+    PoolRun(pool, DecodeJob, b, k);
+    for (int i = 0; i < k; i++) {
+        Slot *s = &b->slot[i];
+        unsigned long long a = first_raw, e = first_raw + s->raw_len;
+        if (!s->ok) {
+            fprintf(stderr, "数据损坏\n");
+            return 0;
+        }
+        if (a < from) a = from;
+        if (e > to) e = to;
+        if (a < e) fwrite(s->raw + (a - first_raw), 1, (size_t)(e - a), out);
+        first_raw += s->raw_len;
+    }
+    return 1;
+}
+
+// 解压：一批一批读入块，线程池并行解码，按顺序写出（不需要索引，可以读管道）
+int Decompress(FILE *in, FILE *out, int threads) {
+    Pool pool;
+    Batch b;
+    unsigned long long raw = 0, packed = 4;
+    char label[32];
+    int version = CheckMagic(in), k, r = 1, type = -1, ret = version ? 0 : 1;
+    double t0 = NowMs();
+
+    if (version == 3) return DecompressAdaptive(in, out);
+    PoolInit(&pool, threads);
+    NewBatch(&b, pool.threads * BATCH_PER_THREAD, 0, 0, 0);
+    while (ret == 0 && r > 0) {
+        for (k = 0; k < b.size; k++) {
+            Slot *s = &b.slot[k];
+            if ((r = ReadBlock(in, &s->type, &s->raw_len, s->enc, &s->enc_len)) <= 0) {
+                type = s->type;
+                break;
+            }
+            packed += BLOCK_HEAD + s->enc_len;
+        }
+        if (r < 0 || (r == 0 && version == 2 && type != ZIP_END)) {
+            fprintf(stderr, r < 0 ? "数据损坏\n" : "文件不完整（没有结束块）\n");
+            ret = 1;
+        }
+        if (ret == 0 && !DecodeBatch(&pool, &b, k, out, raw, 0, ~0ull)) ret = 1;
+        for (int i = 0; i < k; i++) raw += b.slot[i].raw_len;
+    }
+    fflush(out);
+    snprintf(label, sizeof(label), "解压（%d线程）", pool.threads);
+    if (ret == 0) Report(label, raw, packed, NowMs() - t0);
+    FreeBatch(&b);
+    PoolFree(&pool);
+    return ret;
+}
+
+// 随机访问：由末尾的索引找到原文件[offset, offset+length)所在的块，只解码这几块（并行）
+int ExtractRange(FILE *in, FILE *out, unsigned long long offset, unsigned long long length, int threads) {
+    unsigned char buf[BLOCK_HEAD > TRAILER ? BLOCK_HEAD : TRAILER];
+    unsigned long long *index, end, total, stop;
+    unsigned int blocks;
+    size_t first, last, next;
+    Pool pool;
+    Batch b;
+    double t0 = NowMs();
+
+    if (CheckMagic(in) != 2) {
+        fprintf(stderr, "需要带索引的HUF2格式文件\n");
+        return 1;
+    }
+    if (FSEEK64(in, -TRAILER, SEEK_END) != 0 || fread(buf, 1, TRAILER, in) != TRAILER ||
+        memcmp(buf + 8, INDEX_MAGIC, 4) != 0) {
+        fprintf(stderr, "找不到块索引（文件不完整？）\n");
+        return 1;
+    }
+    end = Get64(buf);
+    if (FSEEK64(in, (long long)end, SEEK_SET) != 0 || fread(buf, 1, BLOCK_HEAD, in) != BLOCK_HEAD ||
+        buf[0] != ZIP_END || Get32(buf + 5) != 16ull * (Get32(buf + 1) + 1ull)) {
+        fprintf(stderr, "块索引损坏\n");
+        return 1;
+    }
+    blocks = Get32(buf + 1);
+    index = (unsigned long long *)Alloc(2 * (blocks + 1ull) * sizeof(unsigned long long));
+    for (size_t i = 0; i <= blocks; i++) {
+        unsigned char e[16];
+        if (fread(e, 1, 16, in) != 16) {
+            fprintf(stderr, "块索引损坏\n");
+            free(index);
+            return 1;
+        }
+        index[2 * i] = Get64(e);
+        index[2 * i + 1] = Get64(e + 8);
+        // 两种偏移都必须递增，每块的原始长度不超过HUF_BLOCK_SIZE
+        if (i > 0 && (index[2 * i] <= index[2 * i - 2] || index[2 * i + 1] <= index[2 * i - 1] ||
+                      index[2 * i + 1] - index[2 * i - 1] > HUF_BLOCK_SIZE)) {
+            fprintf(stderr, "块索引损坏\n");
+            free(index);
+            return 1;
+        }
+    }
+    total = index[2 * blocks + 1];
+    if (offset > total) offset = total;
+    stop = length > total - offset ? total : offset + length;
+
+    // 二分找offset所在的块：最后一个原始偏移 ≤ offset 的块
+    first = 0;
+    last = blocks;
+    while (last - first > 1) {
+        size_t mid = (first + last) / 2;
+        if (index[2 * mid + 1] <= offset) first = mid;
+        else last = mid;
+    }
+    PoolInit(&pool, threads);
+    NewBatch(&b, pool.threads * BATCH_PER_THREAD, 0, 0, 0);
+    next = first;
+    while (next < blocks && index[2 * next + 1] < stop) {
+        int k = 0, type;
+        unsigned long long batch_raw = index[2 * next + 1];
+        int seek_ok = FSEEK64(in, (long long)index[2 * next], SEEK_SET) == 0;
+        // 定位失败时k仍为0，与块和索引对不上一样按数据损坏处理
+        while (seek_ok && k < b.size && next < blocks && index[2 * next + 1] < stop) {
+            Slot *s = &b.slot[k];
+            if (ReadBlock(in, &type, &s->raw_len, s->enc, &s->enc_len) != 1 ||
+                s->raw_len != index[2 * next + 3] - index[2 * next + 1]) {
+                k = 0;          // 块与索引对不上
+                break;
+            }
+            s->type = type;
+            k++;
+            next++;
+        }
+        if (k == 0 || !DecodeBatch(&pool, &b, k, out, batch_raw, offset, stop)) {
+            if (k == 0) fprintf(stderr, "数据损坏\n");
+            FreeBatch(&b);
+            PoolFree(&pool);
+            free(index);
+            return 1;
+        }
+    }
+    fflush(out);
+    fprintf(stderr, "随机读取：第%zu~%zu块（共%u块），输出%llu字节，%.1f ms\n", first,
+            next ? next - 1 : 0, blocks, stop - offset, NowMs() - t0);
+    FreeBatch(&b);
+    PoolFree(&pool);
+    free(index);
+    return 0;
+}
+
+// 自适应哈夫曼的同一测试：整个文件编码成一条码流放在内存里，再解码并与重读的文件比对；
+// 与静态编码（enc_ms、dec_ms）的速度并列报告，便于按流选择。往返一致返回1
+static int TestAdaptive(FILE *in, unsigned long long raw, double enc_ms, double dec_ms) {
+    size_t step = (size_t)ADAPTIVE_CHUNK * ADH_MAX_BITS / 8 + 8, cap = step, used, len;
+    unsigned char *buf, *dec, *enc;
+    AdhTree *t;
+    AdhReader *r;
+    BitWriter bw;
+    double ams = 0, adms = 0, t0;
+    long long got;
+    int eof = 0, ok = 1;
+
+    if (fseek(in, 0, SEEK_SET) != 0) {
+        fprintf(stderr, "输入不能重读，跳过与自适应哈夫曼的比较\n");
+        return 1;
+    }
+    buf = (unsigned char *)Alloc(HUF_BLOCK_SIZE);
+    dec = (unsigned char *)Alloc(HUF_BLOCK_SIZE);
+    enc = (unsigned char *)Alloc(cap);
+    t = (AdhTree *)Alloc(sizeof(AdhTree));
+    r = (AdhReader *)Alloc(sizeof(AdhReader));
+    AdhInit(t);
+    InitBits(&bw, enc);
+    while ((len = fread(buf, 1, ADAPTIVE_CHUNK, in)) > 0) {
+        used = (size_t)(bw.p - enc);
+        if (cap - used < step) {            // 不足32位的部分留在bw里，扩容后接着写
+            cap *= 2;
+            if ((enc = (unsigned char *)realloc(enc, cap)) == NULL) {
+                fprintf(stderr, "错误！内存分配失败\n");
+                exit(1);
+            }
+            bw.p = enc + used;
+        }
+        t0 = NowMs();
+        AdhEncode(t, &bw, buf, len);
+        ams += NowMs() - t0;
+    }
+    AdhEncodeEnd(t, &bw);
+    used = (size_t)(FlushBits(&bw) - enc);
+
+    fseek(in, 0, SEEK_SET);
+    AdhInit(t);
+    AdhInitReader(r, NULL, enc, used);
+    while (ok && (len = fread(buf, 1, HUF_BLOCK_SIZE, in)) > 0) {
+        t0 = NowMs();
+        got = AdhDecode(t, r, dec, len, &eof);
+        adms += NowMs() - t0;
+        ok = got == (long long)len && memcmp(buf, dec, len) == 0;
+    }
+    ok = ok && AdhDecode(t, r, dec, 1, &eof) == 0 && eof;   // 原文件读完，接下来正好是结束符
+    Report("自适应压缩（一遍）", raw, 4 + used, ams);
+    Report("自适应解压", raw, 4 + used, adms);
+    fprintf(stderr, "静态两遍编码的压缩速度是自适应的%.1f倍，解压速度是%.1f倍\n",
+            enc_ms > 0 ? ams / enc_ms : 0.0, dec_ms > 0 ? adms / dec_ms : 0.0);
+    free(buf);
+    free(dec);
+    free(enc);
+    free(t);
+    free(r);
+    return ok;
+}
+
+// tANS与哈夫曼逐块对比（每块两种引擎各编码一次）：压缩率、建表时间、编码和解码速度。
+// 建表都从同一张字节直方图开始计时：哈夫曼是限长码长+规范编码+译码表，tANS是归一化+编码表+解码表。
+// 往返一致返回1
+static int CompareEngines(FILE *in, int maxbits, int streams) {
+    static const char *name[2] = {"哈夫曼", "tANS"};
+    unsigned char *buf = (unsigned char *)Alloc(HUF_BLOCK_SIZE);
+    unsigned char *dec = (unsigned char *)Alloc(HUF_BLOCK_SIZE);
+    unsigned char *enc = (unsigned char *)Alloc(HufBound(HUF_BLOCK_SIZE));
+    FseEncodeTable *ct = (FseEncodeTable *)Alloc(sizeof(FseEncodeTable));
+    FseDecodeEntry *dt = (FseDecodeEntry *)Alloc(sizeof(FseDecodeEntry) << FSE_MAX_LOG);
+    unsigned long long raw = 0, size[2] = {4, 4};
+    double build[2] = {0, 0}, enc_ms[2] = {0, 0}, dec_ms[2] = {0, 0}, t0;
+    size_t len, enc_len, blocks = 0, ans = 0;
+    int ok = 1;
+
+    if (fseek(in, 0, SEEK_SET) != 0) {
+        fprintf(stderr, "输入不能重读，跳过tANS与哈夫曼的比较\n");
+        free(buf);
+        free(dec);
+        free(enc);
+        free(ct);
+        free(dt);
+        return 1;
+    }
+    if (maxbits <= 0 || maxbits > HUF_MAXBIT) maxbits = HUF_MAXBIT;
+    while ((len = fread(buf, 1, HUF_BLOCK_SIZE, in)) > 0) {
+        unsigned int count[HUF_SYMBOLS], weight[HUF_SYMBOLS], code[HUF_SYMBOLS], code_of[HUF_SYMBOLS];
+        int len_of[HUF_SYMBOLS], sym_len[HUF_SYMBOLS] = {0}, cnt = 0;
+        unsigned char sym[HUF_SYMBOLS];
+        short norm[HUF_SYMBOLS];
+        size_t huf_len = 0;         // 本块哈夫曼编码的大小
+        HufTable tab;
+
+        ByteHistogram(buf, len, count);
+        for (int c = 0; c < HUF_SYMBOLS; c++) {
+            if (count[c]) {
+                weight[cnt] = count[c];
+                sym[cnt++] = (unsigned char)c;
+            }
+        }
+        if (cnt > 1) {
+            t0 = NowMs();
+            HufLimitLengths(weight, cnt, maxbits, len_of);
+            for (int i = 0; i < cnt; i++) sym_len[sym[i]] = len_of[i];
+            HufCanonicalCodes(sym_len, HUF_SYMBOLS, code);
+            for (int i = 0; i < cnt; i++) code_of[i] = code[sym[i]];
+            if (HufBuildTable(&tab, code_of, len_of, sym, cnt)) HufFreeTable(&tab);
+            build[0] += NowMs() - t0;
+            t0 = NowMs();
+            if (FseNormalize(count, len, FSE_TABLE_LOG, norm)) {
+                FseBuildEncodeTable(ct, norm, FSE_TABLE_LOG);
+                FseBuildDecodeTable(dt, norm, FSE_TABLE_LOG);
+            }
+            build[1] += NowMs() - t0;
+        }
+        for (int e = 0; e < 2; e++) {
+            int type;
+            t0 = NowMs();
+            type = HufEncodeBlock(buf, len, enc, &enc_len, maxbits, streams, e ? HUF_ENGINE_ANS : HUF_ENGINE_HUF);
+            enc_ms[e] += NowMs() - t0;
+            t0 = NowMs();
+            ok = HufDecodeBlock(type, enc, enc_len, dec, len) && ok;
+            dec_ms[e] += NowMs() - t0;
+            ok = ok && memcmp(buf, dec, len) == 0;
+            size[e] += BLOCK_HEAD + enc_len;
+            if (e == 0) huf_len = enc_len;
+            else ans += type == HUF_BLOCK_ANS && enc_len < huf_len;
+        }
+        raw += len;
+        blocks++;
+    }
+    fprintf(stderr, "tANS与哈夫曼对比（%zu块中%zu块tANS比哈夫曼小）：\n", blocks, ans);
+    for (int e = 0; e < 2; e++) {
+        fprintf(stderr, "  %-6s %.2f%%，建表%.1f us/块，编码%.1f MB/s，解码%.1f MB/s\n", name[e],
+                raw ? 100.0 * size[e] / raw : 0.0, blocks ? build[e] * 1000.0 / blocks : 0.0,
+                enc_ms[e] > 0 ? raw / (enc_ms[e] / 1000.0) / 1048576.0 : 0.0,
+                dec_ms[e] > 0 ? raw / (dec_ms[e] / 1000.0) / 1048576.0 : 0.0);
+    }
+    free(buf);
+    free(dec);
+    free(enc);
+    free(ct);
+    free(dt);
+    return ok;
+}
+
+// 测试：逐块压缩再解压并比对，只计编码/解码本身的时间（不含读文件）；
+// 另外报告限长带来的损失：码流比不限长的最优哈夫曼码多多少；
+// 四路时再用哈夫曼按四路、单路各编码一遍，比较两者的解码速度；最后与tANS、自适应哈夫曼对比
+int TestFile(FILE *in, int maxbits, int streams, int engine) {
+    unsigned char *buf = (unsigned char *)Alloc(HUF_BLOCK_SIZE);
+    unsigned char *dec = (unsigned char *)Alloc(HUF_BLOCK_SIZE);
+    unsigned char *enc = (unsigned char *)Alloc(HufBound(HUF_BLOCK_SIZE));
+    unsigned long long raw = 0, packed = 4, packed1 = 4, limited = 0, optimal = 0;
+    double enc_ms = 0, dec_ms = 0, dec1_ms = 0, dec4_ms = 0, t0;
+    size_t len, enc_len;
+    int type, ok = 1;
+
+    while ((len = fread(buf, 1, HUF_BLOCK_SIZE, in)) > 0) {
+        t0 = NowMs();
+        type = HufEncodeBlock(buf, len, enc, &enc_len, maxbits, streams, engine);
+        enc_ms += NowMs() - t0;
+        t0 = NowMs();
+        ok = HufDecodeBlock(type, enc, enc_len, dec, len) && ok;
+        dec_ms += NowMs() - t0;
+        ok = ok && memcmp(buf, dec, len) == 0;
+        raw += len;
+        packed += BLOCK_HEAD + enc_len;
+        if (streams == 4) {             // 各块可能用了tANS，四路与单路的比较固定用哈夫曼
+            for (int k = 0; k < 2; k++) {
+                type = HufEncodeBlock(buf, len, enc, &enc_len, maxbits, k ? 1 : 4, HUF_ENGINE_HUF);
+                t0 = NowMs();
+                ok = HufDecodeBlock(type, enc, enc_len, dec, len) && ok;
+                *(k ? &dec1_ms : &dec4_ms) += NowMs() - t0;
+                ok = ok && memcmp(buf, dec, len) == 0;
+                if (k) packed1 += BLOCK_HEAD + enc_len;
+            }
+        }
+        limited += HufCodedBits(buf, len, maxbits);
+        optimal += HufCodedBits(buf, len, 0);
+    }
+    Report("压缩", raw, packed, enc_ms);
+    Report("解压", raw, packed, dec_ms);
+    if (streams == 4) {
+        Report("哈夫曼单路解压", raw, packed1, dec1_ms);
+        fprintf(stderr, "哈夫曼四路码流解压是单路的%.2f倍\n", dec4_ms > 0 ? dec1_ms / dec4_ms : 0.0);
+    }
+    fprintf(stderr, "码长上限%d位：码流%llu字节，不限长的哈夫曼码%llu字节，多%.3f%%\n", maxbits,
+            (limited + 7) / 8, (optimal + 7) / 8, optimal ? 100.0 * (limited - optimal) / optimal : 0.0);
+    ok = CompareEngines(in, maxbits, streams) && ok;
+    ok = TestAdaptive(in, raw, enc_ms, dec_ms) && ok;
+    fprintf(stderr, "往返校验：%s\n", ok ? "一致" : "不一致！");
+    free(buf);
+    free(dec);
+    free(enc);
+    return ok ? 0 : 1;
+}
+
+int main(int argc, char *argv[]) {
+    FILE *in, *out;
+    int ret, maxbits = HUF_MAXBIT, streams = 4, threads = CpuCount(), adaptive = 0, engine = HUF_ENGINE_HUF;
+
+    INIT_UTF8_CONSOLE();
+    // 可选的 -l 位数：码长上限（如11：译码表只有一级）；-s 路数：码流路数1或4；-t 线程数；
+    // -e huf|ans|auto：每块的熵编码引擎；-a：压缩时改用一遍的自适应哈夫曼（解压按魔数自动识别）
+    while (argc > 2 && argv[1][0] == '-' && strchr("lstea", argv[1][1]) != NULL && argv[1][2] == '\0') {
+        int v = atoi(argv[2]);
+        if (argv[1][1] == 'a') {            // 不带参数
+            adaptive = 1;
+            argc--;
+            argv++;
+            continue;
+        }
+        if (argv[1][1] == 'e') {
+            if (strcmp(argv[2], "huf") == 0) {
+                engine = HUF_ENGINE_HUF;
+            } else if (strcmp(argv[2], "ans") == 0) {
+                engine = HUF_ENGINE_ANS;
+            } else if (strcmp(argv[2], "auto") == 0) {
+                engine = HUF_ENGINE_AUTO;
+            } else {
+                fprintf(stderr, "引擎只能是huf、ans或auto\n");
+                return 1;
+            }
+        } else if (argv[1][1] == 'l') {
+            if (v < HUF_MINBIT || v > HUF_MAXBIT) {
+                fprintf(stderr, "码长上限须在%d~%d之间\n", HUF_MINBIT, HUF_MAXBIT);
+                return 1;
+            }
+            maxbits = v;
+        } else if (argv[1][1] == 's') {
+            if (v != 1 && v != 4) {
+                fprintf(stderr, "码流路数只能是1或4\n");
+                return 1;
+            }
+            streams = v;
+        } else {
+            if (v < 1 || v > MAX_THREADS) {
+                fprintf(stderr, "线程数须在1~%d之间\n", MAX_THREADS);
+                return 1;
+            }
+            threads = v;
+        }
+        argc -= 2;
+        argv += 2;
+    }
+    if (argc == 3 && strcmp(argv[1], "t") == 0) {
+        if ((in = OpenFile(argv[2], "rb")) == NULL) {
+            fprintf(stderr, "无法打开%s\n", argv[2]);
+            return 1;
+        }
+        ret = TestFile(in, maxbits, streams, engine);
+        fclose(in);
+        return ret;
+    }
+    if (argc == 6 && strcmp(argv[1], "r") == 0) {
+        in = fopen(argv[2], "rb");          // 要能定位，不接受管道
+        out = OpenFile(argv[5], "wb");
+        if (in == NULL || out == NULL) {
+            fprintf(stderr, "无法打开输入或输出文件\n");
+            return 1;
+        }
+        ret = ExtractRange(in, out, strtoull(argv[3], NULL, 10), strtoull(argv[4], NULL, 10), threads);
+        fclose(in);
+        if (out != stdout) fclose(out);
+        return ret;
+    }
+    if (argc != 4 || (strcmp(argv[1], "c") != 0 && strcmp(argv[1], "d") != 0)) {
+        fprintf(stderr, "用法：%s [选项] c|d 输入 输出          （\"-\"表示标准输入/输出）\n", argv[0]);
+        fprintf(stderr, "      %s [选项] t 文件                （压缩+解压测试，报告速度和压缩率）\n", argv[0]);
+        fprintf(stderr, "      %s [选项] r 压缩文件 起始字节 长度 输出（按索引只解压原文件的这一段）\n", argv[0]);
+        fprintf(stderr, "选项：-l 码长上限%d~%d，默认%d；-s 码流路数1或4，默认4；-t 线程数，默认%d（CPU核数）；\n"
+                "      -e 熵编码引擎huf、ans（tANS）或auto（每块取小的），默认huf；\n"
+                "      -a 压缩时用一遍的自适应哈夫曼（长度未知的流）\n",
+                HUF_MINBIT, HUF_MAXBIT, HUF_MAXBIT, CpuCount());
+        return 1;
+    }
+    in = OpenFile(argv[2], "rb");
+    out = OpenFile(argv[3], "wb");
+    if (in == NULL || out == NULL) {
+        fprintf(stderr, "无法打开输入或输出文件\n");
+        return 1;
+    }
+    if (argv[1][0] == 'c') {
+        ret = adaptive ? CompressAdaptive(in, out) : Compress(in, out, maxbits, streams, engine, threads);
+    } else {
+        ret = Decompress(in, out, threads);
+    }
+    if (in != stdin) fclose(in);
+    if (out != stdout) fclose(out);
+    return ret;
+}
@@ -2,30 +2,23 @@
 #include<string.h>
 //标准库：用于malloc、free以及其他扩展接口
 #include<stdlib.h>
+#include<time.h>
 #include "../utf8support.h"
+#include "../bytehist.h"
+#include "huffman.h"    // Htreetype和建树函数（与压缩程序共用）
 
 //宏定义
-#define MAXVALUE 10000  // 最大权值（用于初始化哈夫曼树父节点，确保初始不被选作最小节点）
-#define MAXBIT 20       // 哈夫曼编码最大长度：20位足够容纳所有字符的编码，防止溢出
+#define MAXBIT 15       // 哈夫曼编码最大长度：树的深度超过它就改用限长码长（改成11则译码表只有一级）
 #define n 54            // 字符集大小：26大写+26小写+空格+点号=54
 #define m (2*n-1)       // 哈夫曼树总节点数（n个叶子节点+ n-1个非叶子节点）
 
 // 测试字符串
 char test_str[] = "Programmers are perpetual optimists. Most of them think that the way to write a program is to run to the keyboard and start typing. Shortly thereafter the fully debugged program is finished.";
 
-// 哈夫曼树节点结构定义
-typedef struct {
-    char ch;         // 节点对应字符：仅叶子节点有效
-    int weight;      // 节点权重：叶子节点=字符出现频率，非叶子节点=左右子节点权重之和
-    int parent;      // 父节点索引（-1表示无父节点）
-    int Lchild;      // 左孩子索引（-1表示无左孩子）
-    int Rchild;      // 右孩子索引（-1表示无右孩子）
-} Htreetype;
-
 // 哈夫曼编码表结构定义
 typedef struct {
-    char bit[MAXBIT];  // 存储二进制编码（0/1序列）
-    int start;         // 编码在bit数组中的起始位置（从后往前存储）
+    unsigned int code; // 二进制编码：低len位有效，输出时从高位到低位
+    int len;           // 编码长度（位数），建表时算好，编码时不用再数
     char ch;           // 对应的字符
 } Hcodetype;
 
@@ -35,8 +28,8 @@ void CountFrequency(Htreetype ht[]);                 // 统计字符频率
 void CreateHuffmanTree(Htreetype ht[]);              // 构建哈夫曼树
 void CreateHuffmanCode(Htreetype ht[], Hcodetype hc[]); // 生成哈夫曼编码表
 void show(Htreetype t[], Hcodetype code[]);          // 打印编码表
-void Encode(Hcodetype code[], char EncodedBits[], int *len); // 对字符串编码
-void Decode(Htreetype t[], char EncodedBits[], int length); // 对编码串译码
+unsigned char *Encode(Hcodetype code[], const char *text, long long *len); // 对字符串编码
+char *Decode(Hcodetype code[], const unsigned char EncodedBits[], long long length); // 对编码串译码
 void CalculateCompression(Hcodetype hc[], Htreetype ht[]); // 计算压缩效果
 
 // 初始化哈夫曼树：所有节点权重、父母、子女索引置为-1
@@ -56,96 +49,56 @@ void InitHuffmanTree(Htreetype ht[]) {
     ht[53].ch = '.';               // 点号
 }
 
-// 统计测试字符串中各字符的出现频率（权重）
+// 统计测试字符串中各字符的出现频率（权重）：先对整串做字节直方图（见bytehist.h），
+// 再按叶子对应的字符取出计数，不再对每个字符走一串if/else（未定义的字符自然被忽略）
 void CountFrequency(Htreetype ht[]) {
-    int len = strlen(test_str);  //计算测试字符串的长度
-    //遍历字符串的每个字符，更新对应节点的频率（权重）
-    for (int i = 0; i < len; i++) {
-        char c = test_str[i];   //当前遍历到的字符
-        if (c >= 'A' && c <= 'Z') {
-            ht[c - 'A'].weight++;       // 大写字母对应索引0-25
-        } else if (c >= 'a' && c <= 'z') {
-            ht[c - 'a' + 26].weight++;  // 小写字母对应索引26-51
-        } else if (c == ' ') {
-            ht[52].weight++;            // 空格对应索引52
-        } else if (c == '.') {
-            ht[53].weight++;            // 点号对应索引53
-        }
-        // 忽略其他未定义字符
+    unsigned int count[256];
+    ByteHistogram((const unsigned char *)test_str, strlen(test_str), count);
+    for (int i = 0; i < n; i++) {
+        ht[i].weight = (int)count[(unsigned char)ht[i].ch];    // 叶子i对应的字符见InitHuffmanTree
     }
 }
 
 // 构建哈夫曼树：按权重合并节点，生成哈夫曼树
+// 合并次序与原来逐个扫描找两个最小值完全相同，只是改用二叉堆（见huffman.c）
 void CreateHuffmanTree(Htreetype ht[]) {
-    int i, j, k;
-    int min1, min2;  // 存储每次找到的两个最小权重值
-    int idx1, idx2;  // 存储两个最小权重节点的索引
-
     // 先统计字符频率，初始化频率（必须在构建树前执行）
     CountFrequency(ht);
 
     // 构建n-1个非叶子节点（总节点数m=2n-1，需n-1次合并）
-    for (k = n; k < m; k++) {
-        //k从n开始：0~n-1是叶子，n~m-1是非叶子
-        min1 = min2 = MAXVALUE;  // 初始化最小权重为最大值，确保能被更小值替换
-        idx1 = idx2 = -1;        // 初始化最小节点索引为无效值
-
-        //遍历所有已经存在的节点（0~n-1）
-        // 查找当前无父节点（亦即parent=-1）的两个最小权重节点
-        for (i = 0; i < k; i++) {
-            //条件：无父结点（未被合并），且权重小于当前min1
-            if (ht[i].parent == -1 && ht[i].weight < min1) {
-                //把原来的min1和idx1降级为min2和idx2
-                min2 = min1;
-                idx2 = idx1;
-                //更新min1和idx1为当前节点的权重和索引
-                min1 = ht[i].weight;
-                idx1 = i;
-            }
-            //条件：无父节点且权重小于min2但大于min1
-            else if (ht[i].parent == -1 && ht[i].weight < min2) {
-                //只更新min2和idx2
-                min2 = ht[i].weight;
-                idx2 = i;
-            }
-        }
-
-        // 将两个最小节点合并为新节点k
-        ht[idx1].parent = k;    // 第一个最小节点的父节点设为k
-        ht[idx2].parent = k;    // 第二个最小节点的父节点设为k
-        ht[k].Lchild = idx1;    // 新节点k的左孩子为idx1（约定左0右1）
-        ht[k].Rchild = idx2;    // 新节点k的右孩子为idx2
-        ht[k].weight = ht[idx1].weight + ht[idx2].weight;  // 新节点权重为两节点之和
-    }
+    HuffmanBuildHeap(ht, n);
 }
 
-// 生成哈夫曼编码表：从叶子节点回溯到根节点，记录路径（左0右1）
+// 生成哈夫曼编码表：从叶子节点回溯到根节点得到码长，再按码长分配规范编码
 void CreateHuffmanCode(Htreetype ht[], Hcodetype hc[]) {
-    int i, j, p;
-    Hcodetype cd;  // 临时存储单个字符的编码（循环复用，减少内存开销）
+    int i, p, maxlen = 0;
+    int lens[n];            // 各字符的码长
+    unsigned int codes[n], weights[n];
 
-    // 遍历每个叶子节点（0~n-1），为每个字符生成编码
+    // 遍历每个叶子节点（0~n-1），回溯到根节点（parent=-1）数出码长
     for (i = 0; i < n; i++) {
-        cd.start = MAXBIT - 1;  // 编码从bit数组末尾开始存储（因为回溯是从叶子到根，方便后续正向输出）
-        cd.ch = ht[i].ch;       // 绑定当前编码对应字符（与叶子节点一致）
-        p = ht[i].parent;       // p指向当前节点的父节点（从父节点开始回溯）
-        j = i;                  // j指向当前叶子节点（初始位置）
-
-        //回溯循环
-        // 回溯到根节点（parent=-1）
-        while (p != -1) {
-            if (ht[p].Lchild == j) {
-                //当前节点j是父节点p的左孩子，则路径记为‘0’（与建树时左0右1约定一致）
-                cd.bit[cd.start--] = '0';
-            } else {
-                //当前节点j时父节点p的右孩子，则路径记为‘1’
-                cd.bit[cd.start--] = '1';
-            }
-            j = p;              // 移动到父节点（亦即下一轮回溯父节点的父节点）
-            p = ht[p].parent;   // 更新父节点索引
+        lens[i] = 0;
+        for (p = ht[i].parent; p != -1; p = ht[p].parent) {
+            lens[i]++;
         }
-        cd.start++;  // 回溯结束后多减了1，须+1指向编码的第一个有效位
-        hc[i] = cd;  // 将临时编码存入编码表
+        if (lens[i] > maxlen) maxlen = lens[i];
+    }
+    // 权重很悬殊时树可能很深：超过MAXBIT就用package-merge求码长不超过MAXBIT的最优码长
+    if (maxlen > MAXBIT) {
+        for (i = 0; i < n; i++) weights[i] = (unsigned int)ht[i].weight;
+        if (!HufLimitLengths(weights, n, MAXBIT, lens)) {    // 字符数不超过2^MAXBIT，只可能是内存分配失败
+            printf("错误！内存分配失败\n");
+            exit(1);
+        }
+    }
+
+    // 编码只由码长决定（规范哈夫曼编码），与建树时的合并顺序、左右孩子无关，
+    // 所以只需保存码长就能重建编码表
+    HufCanonicalCodes(lens, n, codes);
+    for (i = 0; i < n; i++) {
+        hc[i].code = codes[i];
+        hc[i].len = lens[i];
+        hc[i].ch = ht[i].ch;    // 绑定当前编码对应字符（与叶子节点一致）
     }
 }
 
@@ -159,9 +112,9 @@ void show(Htreetype t[], Hcodetype code[]) {
         if (t[i].weight > 0) {
             //打印当前字符
             printf("%c: ", code[i].ch);
-            //从start开始打印bit数组，输出完整编码，start前的编码无效
-            for (j = code[i].start; j < MAXBIT; j++) {
-                printf("%c", code[i].bit[j]);
+            //从最高位开始打印len位编码
+            for (j = code[i].len - 1; j >= 0; j--) {
+                printf("%c", '0' + (code[i].code >> j & 1));
             }
 
             //打印字符出现次数（权重），亦即“频率高编码短”
@@ -170,68 +123,65 @@ void show(Htreetype t[], Hcodetype code[]) {
     }
 }
 
-// 对测试字符串进行编码：根据编码表生成二进制编码串
-void Encode(Hcodetype code[], char EncodedBits[], int *len) {
-    //定义i为原始字符串索引，cnt为编码穿当前长度（亦即bit数）
-    int i = 0, cnt = 0;
-    //计算原始字符串长度
-    int str_len = strlen(test_str);
-
-    //遍历原始字符串的每个字符，生成编码
-    while (i < str_len) {
-        //当前要编码的字符
-        char c = test_str[i];
-        //存储当前字符在编码表中的索引
-        int j;
-        // 找到当前字符在编码表中的索引
-        if (c >= 'A' && c <= 'Z') {
-            j = c - 'A';
-        } else if (c >= 'a' && c <= 'z') {
-            j = c - 'a' + 26;
-        } else if (c == ' ') {
-            j = 52;
-        } else if (c == '.') {
-            j = 53;
-        } else {
-            i++;
-            continue;  // 跳过未定义字符
-        }
+// 对字符串进行编码：根据编码表生成紧凑的二进制码流（每位真正占1位，高位在前）
+// 返回malloc得到的码流（调用者free），*len返回位数；编码表里没有的字符跳过
+unsigned char *Encode(Hcodetype code[], const char *text, long long *len) {
+    int index[256];             // 字符 -> 编码表下标（-1表示未定义字符）
+    long long bits = 0;
+    size_t str_len = strlen(text);
+    unsigned char *out;
+    BitWriter bw;
+
+    for (int i = 0; i < 256; i++) index[i] = -1;
+    for (int i = 0; i < n; i++) index[(unsigned char)code[i].ch] = i;
+
+    // 先算出总位数，按需分配（不再有固定长度的缓冲区）
+    for (size_t i = 0; i < str_len; i++) {
+        int j = index[(unsigned char)text[i]];
+        if (j >= 0) bits += code[j].len;
+    }
+    out = (unsigned char *)malloc((size_t)(bits / 8) + 8);
+    if (out == NULL) {
+        printf("错误！内存分配失败\n");
+        exit(1);
+    }
 
-        // 计算当前字符的编码长度（有效编码位数）
-        int code_len = MAXBIT - code[j].start;
-        //memcpy亦即内存拷贝，将当前字符的编码复制到编码串数组
-        memcpy(&EncodedBits[cnt], &code[j].bit[code[j].start], code_len);
-        //更新编码串总长度
-        cnt += code_len;
-        //处理下一个
-        i++;
+    // 每个字符的编码放进64位累加器，凑满32位整字写出
+    InitBits(&bw, out);
+    for (size_t i = 0; i < str_len; i++) {
+        int j = index[(unsigned char)text[i]];
+        if (j >= 0) PutBits(&bw, code[j].code, code[j].len);
     }
-    EncodedBits[cnt] = '\0';  // 编码串结尾置空
-    *len = cnt;               // 返回编码串长度（bit数）
+    FlushBits(&bw);
+    *len = bits;
+    return out;
 }
 
-// 对编码串进行译码：根据哈夫曼树还原为原始字符串
-void Decode(Htreetype t[], char EncodedBits[], int length) {
-    int cnt = 0;    // 编码串当前遍历到的索引（bit位）
-    int p = m - 1;  // 从哈夫曼树根节点开始（根节点索引为m-1）
-
-    printf("译码结果：\n");
-
-    // 遍历编码串的所有bit位
-    while (cnt < length) {
-        // 遍历到叶子节点（无左右孩子）时，输出字符并重置为根节点
-        while (t[p].Lchild != -1 && t[p].Rchild != -1) {
-            if (EncodedBits[cnt++] == '0') {  // 修复：0走左子树
-                p = t[p].Lchild;
-            } else {
-                p = t[p].Rchild;  // 修复：1走右子树
-            }
-        }
-        printf("%c", t[p].ch);  // 输出叶子节点对应的字符
-        p = m - 1;              // 重置为根节点，准备下一个字符的译码
+// 对编码串进行译码：由编码表建查找表，每次取HUF_TABLE_BITS位查表得到字符，不再逐位走哈夫曼树
+// 返回malloc得到的字符串（调用者free）
+char *Decode(Hcodetype code[], const unsigned char EncodedBits[], long long length) {
+    unsigned int codes[n];
+    int lens[n];
+    unsigned char syms[n];
+    HufTable table;
+    long long got;
+    char *text = (char *)malloc((size_t)length + 1);    // 每个字符至少1位
+
+    for (int i = 0; i < n; i++) {
+        codes[i] = code[i].code;
+        lens[i] = code[i].len;
+        syms[i] = (unsigned char)code[i].ch;
     }
-    printf("\n");
+    if (text == NULL || !HufBuildTable(&table, codes, lens, syms, n)) {
+        printf("错误！内存分配失败\n");
+        exit(1);
+    }
+    got = HufDecode(&table, EncodedBits, length, (unsigned char *)text, length);
+    HufFreeTable(&table);
+    text[got < 0 ? 0 : got] = '\0';
+    return text;
 }
+
 // 计算并分析压缩效果
 void CalculateCompression(Hcodetype hc[], Htreetype ht[]) {
     int original_len = strlen(test_str) * 6;  // 原始长度：假设每个字符6位（简化计算）
@@ -240,8 +190,7 @@ void CalculateCompression(Hcodetype hc[], Htreetype ht[]) {
     // 计算编码后总长度：每个字符的频率×编码长度之和
     for (int i = 0; i < n; i++) {
         if (ht[i].weight > 0) {
-            int code_len = MAXBIT - hc[i].start;
-            encoded_len += ht[i].weight * code_len;
+            encoded_len += ht[i].weight * hc[i].len;
         }
     }
 
@@ -253,13 +202,192 @@ void CalculateCompression(Hcodetype hc[], Htreetype ht[]) {
     printf("说明：哈夫曼编码通过“频率高的字符用短编码”实现无损压缩，频率分布越不均匀，压缩效果越好。\n");
 }
 
+// 性能测试用的伪随机数（xorshift）和墙上时间（毫秒）
+static unsigned long long bench_seed = 88172645463325252ULL;
+static unsigned int BenchRand(void) {
+    bench_seed ^= bench_seed << 13;
+    bench_seed ^= bench_seed >> 7;
+    bench_seed ^= bench_seed << 17;
+    return (unsigned int)(bench_seed >> 32);
+}
+
+static double NowMs(void) {
+#ifdef _WIN32
+    LARGE_INTEGER freq, now;
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&now);
+    return (double)now.QuadPart * 1000.0 / (double)freq.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+#endif
+}
+
+static int CompareInt(const void *a, const void *b) {
+    int x = *(const int *)a, y = *(const int *)b;
+    return (x > y) - (x < y);
+}
+
+// 建树性能测试：叶子数从256到1M，比较扫描、二叉堆、双队列（权重预先排好序）
+// 权重取1~1000，1M个叶子时总和也不会溢出int
+int RunBuildBenchmark(void) {
+    int sizes[] = {256, 4096, 16384, 65536, 1 << 20};
+    int scan_limit = 16384;     // 扫描法是O(n²)，再大就不测了
+
+    printf("%10s %12s %12s %12s %14s\n", "叶子数", "扫描(ms)", "二叉堆(ms)", "双队列(ms)", "排序+双队列(ms)");
+    for (int s = 0; s < (int)(sizeof(sizes) / sizeof(sizes[0])); s++) {
+        int cnt = sizes[s], *w = (int *)malloc(cnt * sizeof(int));
+        Htreetype *a = (Htreetype *)malloc((2 * cnt - 1) * sizeof(Htreetype));
+        Htreetype *b = (Htreetype *)malloc((2 * cnt - 1) * sizeof(Htreetype));
+        double t0, scan_ms = -1, heap_ms, sorted_ms, sort_ms;
+        int same = 1;
+
+        if (w == NULL || a == NULL || b == NULL) {
+            printf("错误！内存分配失败\n");
+            exit(1);
+        }
+        for (int i = 0; i < cnt; i++) w[i] = 1 + (int)(BenchRand() % 1000);
+
+        // 随机权重：二叉堆，与扫描法逐项对照
+        for (int i = 0; i < cnt; i++) a[i].weight = b[i].weight = w[i];
+        t0 = NowMs();
+        HuffmanBuildHeap(a, cnt);
+        heap_ms = NowMs() - t0;
+        if (cnt <= scan_limit) {
+            t0 = NowMs();
+            HuffmanBuildScan(b, cnt);
+            scan_ms = NowMs() - t0;
+            same = memcmp(a, b, (2 * cnt - 1) * sizeof(Htreetype)) == 0;
+        }
+
+        // 排好序的权重：双队列，与二叉堆对照
+        t0 = NowMs();
+        qsort(w, cnt, sizeof(int), CompareInt);
+        sort_ms = NowMs() - t0;
+        for (int i = 0; i < cnt; i++) a[i].weight = b[i].weight = w[i];
+        t0 = NowMs();
+        HuffmanBuildSorted(a, cnt);
+        sorted_ms = NowMs() - t0;
+        HuffmanBuildHeap(b, cnt);
+        same = same && memcmp(a, b, (2 * cnt - 1) * sizeof(Htreetype)) == 0;
+
+        if (scan_ms >= 0) printf("%10d %12.2f", cnt, scan_ms);
+        else printf("%10d %12s", cnt, "-");
+        printf(" %12.2f %12.2f %14.2f  %s\n", heap_ms, sorted_ms, sort_ms + sorted_ms,
+               same ? "结果一致" : "结果不一致！");
+        free(w);
+        free(a);
+        free(b);
+    }
+    return 0;
+}
+
+// 原来的统计方法：每个字符走一串if/else，再给对应叶子的权重加1（只用于性能对比）
+static void CountBranchy(const char *text, size_t len, int weight[n]) {
+    for (size_t i = 0; i < len; i++) {
+        char c = text[i];
+        if (c >= 'A' && c <= 'Z') {
+            weight[c - 'A']++;
+        } else if (c >= 'a' && c <= 'z') {
+            weight[c - 'a' + 26]++;
+        } else if (c == ' ') {
+            weight[52]++;
+        } else if (c == '.') {
+            weight[53]++;
+        }
+    }
+}
+
+// 频率统计吞吐：测试字符串重复到约64MB，以及64MB全是空格（同一个计数器被连续更新的最坏情况）
+int RunCountBenchmark(void) {
+    size_t one = strlen(test_str), reps = (64u << 20) / one, total = one * reps;
+    char *text = (char *)malloc(total);
+    const char *names[2] = {"测试字符串", "全空格"};
+
+    if (text == NULL) {
+        printf("错误！内存分配失败\n");
+        exit(1);
+    }
+    printf("\n频率统计（%.1f MB）：\n", total / 1048576.0);
+    for (int k = 0; k < 2; k++) {
+        int weight[n] = {0};
+        unsigned int count[256];
+        double t0, ms1, ms2;
+        int same = 1;
+
+        if (k == 0) {
+            for (size_t i = 0; i < reps; i++) memcpy(text + i * one, test_str, one);
+        } else {
+            memset(text, ' ', total);
+        }
+        t0 = NowMs();
+        CountBranchy(text, total, weight);
+        ms1 = NowMs() - t0;
+        t0 = NowMs();
+        ByteHistogram((const unsigned char *)text, total, count);
+        ms2 = NowMs() - t0;
+        for (int i = 0; i < 26; i++) {
+            same = same && weight[i] == (int)count['A' + i] && weight[i + 26] == (int)count['a' + i];
+        }
+        same = same && weight[52] == (int)count[' '] && weight[53] == (int)count['.'];
+        printf("  %s：if/else逐字符 %.3f ns/字节，字节直方图 %.3f ns/字节（%.0f MB/s），结果%s\n", names[k],
+               ms1 * 1e6 / total, ms2 * 1e6 / total, total / (ms2 / 1000.0) / 1048576.0, same ? "一致" : "不一致！");
+    }
+    free(text);
+    return 0;
+}
+
+// 编解码吞吐：把测试字符串重复到约64MB，用测试字符串的编码表编码，再查表译码并与原文比对
+int RunEncodeBenchmark(void) {
+    Htreetype ht[m];
+    Hcodetype hc[n];
+    size_t one = strlen(test_str), reps = (64u << 20) / one;
+    char *text = (char *)malloc(one * reps + 1);
+    unsigned char *bits;
+    char *back;
+    long long len;
+    double t0, ms;
+
+    if (text == NULL) {
+        printf("错误！内存分配失败\n");
+        exit(1);
+    }
+    for (size_t i = 0; i < reps; i++) memcpy(text + i * one, test_str, one);
+    text[one * reps] = '\0';
+    InitHuffmanTree(ht);
+    CreateHuffmanTree(ht);
+    CreateHuffmanCode(ht, hc);
+
+    t0 = NowMs();
+    bits = Encode(hc, text, &len);
+    ms = NowMs() - t0;
+    printf("\n编码%.1f MB文本 -> %.1f MB码流：%.1f ms，%.1f MB/s\n", one * reps / 1048576.0,
+           len / 8.0 / 1048576.0, ms, one * reps / (ms / 1000.0) / 1048576.0);
+
+    t0 = NowMs();
+    back = Decode(hc, bits, len);
+    ms = NowMs() - t0;
+    printf("译码：%.1f ms，%.1f MB/s，%s\n", ms, one * reps / (ms / 1000.0) / 1048576.0,
+           strcmp(back, text) == 0 ? "与原文一致" : "与原文不一致！");
+    free(back);
+    free(bits);
+    free(text);
+    return 0;
+}
+
 // 主函数：串联哈夫曼树构建、编码、译码、压缩分析流程
-int main() {
+int main(int argc, char *argv[]) {
     INIT_UTF8_CONSOLE();
+    // 命令行 bench：建树、频率统计、编解码性能测试
+    if (argc > 1 && strcmp(argv[1], "bench") == 0) {
+        return RunBuildBenchmark() || RunCountBenchmark() || RunEncodeBenchmark();
+    }
     Htreetype ht[m];    // 哈夫曼树数组
     Hcodetype hc[n];    // 哈夫曼编码表数组
-    char EncodedBits[1024];  // 存储编码后的二进制串（足够容纳测试字符串）
-    int encoded_len;    // 编码串长度
+    unsigned char *EncodedBits;  // 编码后的码流（按位紧凑存放）
+    long long encoded_len;       // 码流长度（位数）
+    char *DecodedText;           // 译码得到的字符串
 
     // 1. 初始化并构建哈夫曼树
     InitHuffmanTree(ht);
@@ -271,15 +399,21 @@ int main() {
 
     // 3. 对测试字符串编码并输出
     printf("\n编码结果（二进制串）：\n");
-    Encode(hc, EncodedBits, &encoded_len);
-    printf("%s\n", EncodedBits);
-    printf("编码后长度：%d bit\n", encoded_len);
+    EncodedBits = Encode(hc, test_str, &encoded_len);
+    for (long long i = 0; i < encoded_len; i++) {
+        putchar('0' + (EncodedBits[i >> 3] >> (7 - (i & 7)) & 1));
+    }
+    printf("\n");
+    printf("编码后长度：%lld bit\n", encoded_len);
 
     // 4. 对编码串译码并输出
-    Decode(ht, EncodedBits, encoded_len);
+    DecodedText = Decode(hc, EncodedBits, encoded_len);
+    printf("译码结果：\n%s\n", DecodedText);
 
     // 5. 计算并输出压缩效果
     CalculateCompression(hc, ht);
 
+    free(DecodedText);
+    free(EncodedBits);
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,48 @@
+#ifndef BYTE_HIST_H
+#define BYTE_HIST_H
+
+#include <stddef.h>
+#include <string.h>
+
+// 字节直方图：统计buf中256个字节值各出现几次，写入count[0..255]（会先清零）。
+// 逐字节count[b]++时，相邻的相同字节要等上一次“读-加1-写回”完成（存储转发），
+// 遇到大段相同字节（空格、0）每字节要好几个周期。这里把字节轮流分给8张子表，
+// 同一张子表的两次更新之间隔着7次别的更新，互不等待；输入按8字节整字读入，最后把子表相加。
+// 计数是32位，一次调用的长度须小于4G
+#define BYTE_HIST_WAYS 8
+
+static inline void ByteHistogram(const unsigned char *buf, size_t len, unsigned int count[256]) {
+    unsigned int sub[BYTE_HIST_WAYS][256];
+    size_t i = 0;
+
+    memset(sub, 0, sizeof(sub));
+    for (; i + 16 <= len; i += 16) {
+        unsigned long long x, y;
+        memcpy(&x, buf + i, 8);         // 与字节序无关：哪个字节进哪张子表都可以
+        memcpy(&y, buf + i + 8, 8);
+        sub[0][x & 255]++;
+        sub[1][x >> 8 & 255]++;
+        sub[2][x >> 16 & 255]++;
+        sub[3][x >> 24 & 255]++;
+        sub[4][x >> 32 & 255]++;
+        sub[5][x >> 40 & 255]++;
+        sub[6][x >> 48 & 255]++;
+        sub[7][x >> 56]++;
+        sub[0][y & 255]++;
+        sub[1][y >> 8 & 255]++;
+        sub[2][y >> 16 & 255]++;
+        sub[3][y >> 24 & 255]++;
+        sub[4][y >> 32 & 255]++;
+        sub[5][y >> 40 & 255]++;
+        sub[6][y >> 48 & 255]++;
+        sub[7][y >> 56]++;
+    }
+    for (; i < len; i++) sub[i & (BYTE_HIST_WAYS - 1)][buf[i]]++;
+    for (int c = 0; c < 256; c++) {
+        unsigned int t = 0;
+        for (int k = 0; k < BYTE_HIST_WAYS; k++) t += sub[k][c];
+        count[c] = t;
+    }
+}
+
+#endif // BYTE_HIST_H
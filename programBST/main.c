@@ -1,5 +1,8 @@
 #include<stdio.h>
 #include<stdlib.h>
+#include<string.h>
+#include<time.h>
+#include<pthread.h>
 #include "../utf8support.h"
 
 // 给定的20个整数数据
@@ -9,6 +12,7 @@ typedef int Status;
 // 定义二叉排序树节点结构
 typedef struct BiNode {
     int data;               // 存储节点数据
+    int size;               // 以该节点为根的子树节点总数（顺序统计用，插入/删除时维护）
     struct BiNode *lchild;  // 左子树指针
     struct BiNode *rchild;  // 右子树指针
 } BiNode, *BiTree;
@@ -17,11 +21,20 @@ typedef struct BiNode {
 void show_num(int n, int *num);          // 输出数组数据
 BiTree CreateBST(int *num, int n);       // 构建二叉排序树
 BiTree InsertBST(BiTree T, int key);     // 插入节点到二叉排序树
+BiTree SearchBST(BiTree T, int key);     // 查找关键字等于key的节点
 void PreOrder(BiTree T);                 // 前序遍历
 void InOrder(BiTree T);                  // 中序遍历
 void PostOrder(BiTree T);                // 后序遍历
 Status FindDeleteBST(BiTree *T, int key); // 删除指定值的节点
 BiTree FindMin(BiTree T);                // 查找左子树最大值（用于双孩子节点删除）
+int SizeBST(BiTree T);                   // 子树节点数（空树为0）
+BiTree Select(BiTree T, int k);          // 查找第k小的节点（k从1开始）
+int Rank(BiTree T, int key);             // 统计不大于key的关键字个数
+void FreeBST(BiTree T);                  // 释放整棵树
+BiTree BalanceBST(BiTree T);             // 把任意二叉排序树重排为平衡的树堆（treap）
+BiTree UnionBST(BiTree A, BiTree B);     // 并集（A、B被消耗，重复节点释放）
+BiTree IntersectBST(BiTree A, BiTree B); // 交集
+BiTree DifferenceBST(BiTree A, BiTree B);// 差集 A-B
 
 // 输出数组中的所有数据
 void show_num(int n, int *num) {
@@ -37,6 +50,7 @@ BiTree InsertBST(BiTree T, int key) {
     if (T == NULL) {
         T = (BiTree)malloc(sizeof(BiNode));  // 给新节点分配内存（申请一块空间）
         T->data = key;                       // 新节点的数据设为要插入的key
+        T->size = 1;                         // 新节点自身构成大小为1的子树
         T->lchild = T->rchild = NULL;        // 新节点的左右孩子初始为空（叶子节点）
     }
         // 情况2：要插入的key < 当前节点数据 → 递归插入到左子树
@@ -48,9 +62,19 @@ BiTree InsertBST(BiTree T, int key) {
         T->rchild = InsertBST(T->rchild, key);  // 右孩子指针指向插入后的右子树
     }
     // 情况4：key == 当前节点数据（默认不插入，避免重复节点）
+    // 回溯时按左右子树重新计算size（重复key不插入时size保持不变）
+    T->size = SizeBST(T->lchild) + SizeBST(T->rchild) + 1;
     return T;  // 返回插入后的树（根节点不变，子树可能更新）
 }
 
+// 查找关键字等于key的节点（非递归），找不到返回NULL
+BiTree SearchBST(BiTree T, int key) {
+    while (T != NULL && T->data != key) {
+        T = (key < T->data) ? T->lchild : T->rchild;  // 小往左，大往右
+    }
+    return T;
+}
+
 // 构建二叉排序树：逐个插入数组元素
 BiTree CreateBST(int *num, int n) {
     BiTree T = NULL;
@@ -60,31 +84,212 @@ BiTree CreateBST(int *num, int n) {
     return T;
 }
 
-// 前序遍历：根→左→右
-void PreOrder(BiTree T) {
-    if (T != NULL) {
-        printf("%3d ", T->data);  // 1. 先访问根
-        PreOrder(T->lchild);      // 2. 再遍历左
-        PreOrder(T->rchild);      // 3. 最后遍历右
+// ====================== 非递归遍历迭代器 + 批量输出 ======================
+// 遍历顺序
+typedef enum {
+    ITER_PRE,        // 前序（显式栈）
+    ITER_IN,         // 中序（显式栈）
+    ITER_POST,       // 后序（显式栈）
+    ITER_MORRIS_IN   // 中序（Morris线索化，O(1)额外空间，遍历期间会临时修改右指针）
+} IterOrder;
+
+// 遍历迭代器：每次NextBatch把若干个key写进调用者提供的数组
+typedef struct {
+    IterOrder order;
+    BiTree cur;      // 中序/Morris：下一个要处理的节点；前序/后序：未使用
+    BiTree last;     // 后序：上一个输出的节点（判断右子树是否已访问）
+    BiTree *stack;   // 显式栈（按需倍增，不受递归深度限制）
+    int top;         // 栈顶下标（栈中元素个数）
+    int cap;         // 栈容量
+} BSTIter;
+
+// 入栈（栈满时容量翻倍）
+static void IterPush(BSTIter *it, BiTree p) {
+    if (it->top == it->cap) {
+        it->cap = it->cap ? it->cap * 2 : 64;
+        it->stack = (BiTree *)realloc(it->stack, it->cap * sizeof(BiTree));
+        if (it->stack == NULL) {
+            printf("错误！迭代器栈内存分配失败\n");
+            exit(1);
+        }
+    }
+    it->stack[it->top++] = p;
+}
+
+// 初始化迭代器
+void InitIter(BSTIter *it, BiTree T, IterOrder order) {
+    it->order = order;
+    it->cur = T;
+    it->last = NULL;
+    it->stack = NULL;
+    it->top = it->cap = 0;
+    if ((order == ITER_PRE || order == ITER_POST) && T != NULL) IterPush(it, T);
+}
+
+// 取下一批key写入buf（最多cap个），返回实际写入个数，返回0表示遍历结束
+int NextBatch(BSTIter *it, int *buf, int cap) {
+    int cnt = 0;
+    BiTree p, pre;
+
+    switch (it->order) {
+        case ITER_PRE:
+            // 弹出即访问，先压右再压左，保证左子树先出栈
+            while (cnt < cap && it->top > 0) {
+                p = it->stack[--it->top];
+                buf[cnt++] = p->data;
+                if (p->rchild) IterPush(it, p->rchild);
+                if (p->lchild) IterPush(it, p->lchild);
+            }
+            break;
+
+        case ITER_IN:
+            // 一路向左压栈，弹出时访问并转向右子树
+            while (cnt < cap && (it->cur != NULL || it->top > 0)) {
+                while (it->cur != NULL) {
+                    IterPush(it, it->cur);
+                    it->cur = it->cur->lchild;
+                }
+                p = it->stack[--it->top];
+                buf[cnt++] = p->data;
+                it->cur = p->rchild;
+            }
+            break;
+
+        case ITER_POST:
+            // 栈顶节点的孩子都已访问（或没有孩子）才输出，否则先压孩子
+            while (cnt < cap && it->top > 0) {
+                p = it->stack[it->top - 1];
+                if ((p->lchild == NULL && p->rchild == NULL) ||
+                    (it->last != NULL && (it->last == p->lchild || it->last == p->rchild))) {
+                    buf[cnt++] = p->data;
+                    it->last = p;
+                    it->top--;
+                } else {
+                    if (p->rchild) IterPush(it, p->rchild);
+                    if (p->lchild) IterPush(it, p->lchild);
+                }
+            }
+            break;
+
+        case ITER_MORRIS_IN:
+            // 左子树最右节点的空右指针临时指回当前节点，第二次到达时还原
+            while (cnt < cap && it->cur != NULL) {
+                p = it->cur;
+                if (p->lchild == NULL) {
+                    buf[cnt++] = p->data;
+                    it->cur = p->rchild;
+                    continue;
+                }
+                pre = p->lchild;
+                while (pre->rchild != NULL && pre->rchild != p) pre = pre->rchild;
+                if (pre->rchild == NULL) {
+                    pre->rchild = p;          // 建立线索，先去遍历左子树
+                    it->cur = p->lchild;
+                } else {
+                    pre->rchild = NULL;       // 左子树已遍历完，拆除线索
+                    buf[cnt++] = p->data;
+                    it->cur = p->rchild;
+                }
+            }
+            break;
+    }
+    return cnt;
+}
+
+// 释放迭代器；Morris中途放弃时把剩余部分走完，保证临时线索全部拆除
+void FreeIter(BSTIter *it) {
+    int drain[256];
+    if (it->order == ITER_MORRIS_IN) {
+        while (NextBatch(it, drain, 256) > 0);
+    }
+    free(it->stack);
+    it->stack = NULL;
+    it->top = it->cap = 0;
+}
+
+// 整数转文本的输出缓冲：攒满一整块再fwrite，避免每个key一次printf
+#define SINK_SIZE 65536
+typedef struct {
+    FILE *fp;
+    int len;                // 缓冲区已用字节数
+    char buf[SINK_SIZE];
+} KeySink;
+
+// 两位一组的数字查表，一次处理两位十进制
+static const char digit_pairs[201] =
+        "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+        "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+        "8081828384858687888990919293949596979899";
+
+void SinkInit(KeySink *s, FILE *fp) {
+    s->fp = fp;
+    s->len = 0;
+}
+
+void SinkFlush(KeySink *s) {
+    if (s->len > 0) fwrite(s->buf, 1, s->len, s->fp);
+    s->len = 0;
+}
+
+// 批量写入key：每个key右对齐到width位（等价于"%*d"），后跟分隔符sep
+void SinkPutKeys(KeySink *s, const int *keys, int cnt, int width, char sep) {
+    char tmp[12];
+    int i, k, pos, digits;
+    unsigned int v;
+
+    for (i = 0; i < cnt; i++) {
+        if (s->len > SINK_SIZE - 64 - width) SinkFlush(s);  // 预留一个key的最大长度
+        v = keys[i] < 0 ? 0u - (unsigned int)keys[i] : (unsigned int)keys[i];
+        pos = 12;
+        while (v >= 100) {              // 从低位起每次写两位
+            k = (int)(v % 100) * 2;
+            v /= 100;
+            tmp[--pos] = digit_pairs[k + 1];
+            tmp[--pos] = digit_pairs[k];
+        }
+        if (v >= 10) {
+            tmp[--pos] = digit_pairs[v * 2 + 1];
+            tmp[--pos] = digit_pairs[v * 2];
+        } else {
+            tmp[--pos] = (char)('0' + v);
+        }
+        if (keys[i] < 0) tmp[--pos] = '-';
+        digits = 12 - pos;
+        for (k = digits; k < width; k++) s->buf[s->len++] = ' ';
+        memcpy(s->buf + s->len, tmp + pos, digits);
+        s->len += digits;
+        s->buf[s->len++] = sep;
+    }
+}
+
+// 按指定顺序遍历并以"%3d "格式输出到标准输出
+static void PrintByIter(BiTree T, IterOrder order) {
+    static KeySink sink;   // 64KB缓冲放静态区，不占栈
+    int batch[256], cnt;
+    BSTIter it;
+
+    SinkInit(&sink, stdout);
+    InitIter(&it, T, order);
+    while ((cnt = NextBatch(&it, batch, 256)) > 0) {
+        SinkPutKeys(&sink, batch, cnt, 3, ' ');
     }
+    FreeIter(&it);
+    SinkFlush(&sink);
+}
+
+// 前序遍历：根→左→右（显式栈，退化树也不会栈溢出）
+void PreOrder(BiTree T) {
+    PrintByIter(T, ITER_PRE);
 }
 
 // 中序遍历函数体 左->根->右
 void InOrder(BiTree T) {
-    if (T != NULL) {
-        InOrder(T->lchild);       // 递归遍历左子树
-        printf("%3d ", T->data);  // 访问根节点
-        InOrder(T->rchild);       // 递归遍历右子树
-    }
+    PrintByIter(T, ITER_IN);
 }
 
 // 后序遍历：左→右→根
 void PostOrder(BiTree T) {
-    if (T != NULL) {
-        PostOrder(T->lchild);     // 1. 先遍历左
-        PostOrder(T->rchild);     // 2. 再遍历右
-        printf("%3d ", T->data);  // 3. 最后访问根
-    }
+    PrintByIter(T, ITER_POST);
 }
 
 
@@ -110,6 +315,11 @@ Status FindDeleteBST(BiTree *T, int key) {
     }
     if (p == NULL) return 0;  // 没找到目标节点，删除失败
 
+    // 确认删除后，根到p路径上（不含p）每个祖先的子树都少一个节点
+    for (s = *T; s != p; s = (key < s->data) ? s->lchild : s->rchild) {
+        s->size--;
+    }
+
     // 第二步：分3种情况删除节点p
     // 情况1：p是叶子节点（无左/右子树）
     if (p->lchild == NULL && p->rchild == NULL) {
@@ -138,8 +348,10 @@ Status FindDeleteBST(BiTree *T, int key) {
         // 情况4：p有两个子树（最复杂的情况）
     else {
         q = p;                // q记录p的位置（后续要修改p的数据）
+        p->size--;            // p保留（只换值），但实际摘除的s在p的子树中
         s = p->lchild;        // s从p的左子树开始找
         while (s->rchild != NULL) {  // 找p左子树的最大值节点s（最右节点）
+            s->size--;        // p到s路径上的节点子树都少一个节点
             q = s;            // q记录s的父节点
             s = s->rchild;
         }
@@ -152,9 +364,820 @@ Status FindDeleteBST(BiTree *T, int key) {
     return 1;  // 删除成功
 }
 
+// 子树节点数：空树为0，非空直接读取size域（O(1)）
+int SizeBST(BiTree T) {
+    return T ? T->size : 0;
+}
+
+// 查找第k小的节点（k从1开始）：利用左子树大小决定往哪边走，O(树高)
+BiTree Select(BiTree T, int k) {
+    while (T != NULL) {
+        int ls = SizeBST(T->lchild);  // 左子树中比当前节点小的节点数
+        if (k <= ls) {
+            T = T->lchild;            // 第k小在左子树
+        } else if (k == ls + 1) {
+            return T;                 // 当前节点恰好是第k小
+        } else {
+            k -= ls + 1;              // 跳过左子树和当前节点，到右子树找剩下的
+            T = T->rchild;
+        }
+    }
+    return NULL;  // k越界（k<1或k>节点总数）
+}
+
+// 统计树中不大于key的关键字个数，O(树高)
+// key在树中时返回值就是它在中序序列里的位置（从1开始）
+int Rank(BiTree T, int key) {
+    int r = 0;
+    while (T != NULL) {
+        if (key < T->data) {
+            T = T->lchild;                          // 右侧全部大于key，不计数
+        } else {
+            r += SizeBST(T->lchild) + 1;            // 左子树和当前节点都不大于key
+            if (key == T->data) break;
+            T = T->rchild;
+        }
+    }
+    return r;
+}
+
+// ====================== 基于join/split的集合运算（并、交、差） ======================
+// 平衡方式采用树堆（treap）：节点优先级由key哈希得到，不需要额外字段，
+// 同一组key无论插入顺序如何都得到同一棵树，期望树高O(log n)。
+// 所有集合运算都只依赖Join/Split，工作量为O(m log(n/m + 1))（m<=n），
+// 左右子问题互不相关，规模足够大时交给新线程并行计算（fork-join）。
+
+#define SETOP_CUTOFF 20000  // 子问题节点数低于该值时不再创建线程
+static int setop_fork_depth = 0;  // 允许创建线程的递归层数（由SetOpThreads设置）
+
+// 节点优先级：key的整数哈希
+static unsigned int Priority(int key) {
+    unsigned int x = (unsigned int)key;
+    x ^= x >> 16;
+    x *= 0x7feb352dU;
+    x ^= x >> 15;
+    x *= 0x846ca68bU;
+    x ^= x >> 16;
+    return x;
+}
+
+// a的优先级是否高于b（空树优先级最低；哈希相同时按key区分，保证全序）
+static int HigherPriority(BiTree a, BiTree b) {
+    unsigned int pa, pb;
+    if (a == NULL) return 0;
+    if (b == NULL) return 1;
+    pa = Priority(a->data);
+    pb = Priority(b->data);
+    return pa > pb || (pa == pb && a->data < b->data);
+}
+
+// 按左右子树重新计算size
+static void UpdateSize(BiTree T) {
+    T->size = SizeBST(T->lchild) + SizeBST(T->rchild) + 1;
+}
+
+// Join：L中所有key < k->data < R中所有key，把三者拼成一棵treap
+BiTree JoinBST(BiTree L, BiTree k, BiTree R) {
+    if (!HigherPriority(L, k) && !HigherPriority(R, k)) {
+        k->lchild = L;        // k优先级最高，直接作为根
+        k->rchild = R;
+        UpdateSize(k);
+        return k;
+    }
+    if (HigherPriority(L, R)) {
+        L->rchild = JoinBST(L->rchild, k, R);  // k沿L的右脊下沉
+        UpdateSize(L);
+        return L;
+    }
+    R->lchild = JoinBST(L, k, R->lchild);      // k沿R的左脊下沉
+    UpdateSize(R);
+    return R;
+}
+
+// 无中间节点的拼接：L中所有key < R中所有key
+static BiTree Join2BST(BiTree L, BiTree R) {
+    if (L == NULL) return R;
+    if (R == NULL) return L;
+    if (HigherPriority(L, R)) {
+        L->rchild = Join2BST(L->rchild, R);
+        UpdateSize(L);
+        return L;
+    }
+    R->lchild = Join2BST(L, R->lchild);
+    UpdateSize(R);
+    return R;
+}
+
+// Split：按key把T拆成 <key 的L 和 >key 的R，等于key的节点摘出来放到*found（没有则为NULL）
+void SplitBST(BiTree T, int key, BiTree *L, BiTree *found, BiTree *R) {
+    if (T == NULL) {
+        *L = *R = *found = NULL;
+    } else if (key == T->data) {
+        *L = T->lchild;
+        *R = T->rchild;
+        T->lchild = T->rchild = NULL;
+        T->size = 1;
+        *found = T;
+    } else if (key < T->data) {
+        SplitBST(T->lchild, key, L, found, &T->lchild);  // 左子树拆剩的右半部分仍挂在T左边
+        UpdateSize(T);
+        *R = T;
+    } else {
+        SplitBST(T->rchild, key, &T->rchild, found, R);
+        UpdateSize(T);
+        *L = T;
+    }
+}
+
+// 释放整棵树：不断右旋把左子树转到右边再逐个释放，不用栈也不递归
+void FreeBST(BiTree T) {
+    BiTree p;
+    while (T != NULL) {
+        if (T->lchild != NULL) {
+            p = T->lchild;            // 右旋：左孩子上提
+            T->lchild = p->rchild;
+            p->rchild = T;
+            T = p;
+        } else {
+            p = T->rchild;
+            free(T);
+            T = p;
+        }
+    }
+}
+
+// 把按key升序排列的节点数组链接成treap（笛卡尔树栈式构造，O(n)）
+static BiTree LinkTreap(BiTree *nodes, int cnt) {
+    BiTree *stk, last, x;
+    int i, top = 0;
+
+    if (cnt == 0) return NULL;
+    stk = (BiTree *)malloc(cnt * sizeof(BiTree));
+    if (stk == NULL) {
+        printf("错误！内存分配失败\n");
+        exit(1);
+    }
+    for (i = 0; i < cnt; i++) {
+        x = nodes[i];
+        last = NULL;
+        // 右脊上优先级比x低的节点都成为x的左子树；出栈时子树已定形，顺便算size
+        while (top > 0 && HigherPriority(x, stk[top - 1])) {
+            last = stk[--top];
+            UpdateSize(last);
+        }
+        x->lchild = last;
+        x->rchild = NULL;
+        if (top > 0) stk[top - 1]->rchild = x;
+        stk[top++] = x;
+    }
+    while (top > 0) UpdateSize(stk[--top]);
+    x = stk[0];
+    free(stk);
+    return x;
+}
+
+// 把任意二叉排序树（例如CreateBST的结果）原地重排为treap，复用原有节点
+BiTree BalanceBST(BiTree T) {
+    BiTree *nodes, *stk, p = T;
+    int cnt = 0, top = 0, total = SizeBST(T);
+
+    if (T == NULL) return NULL;
+    nodes = (BiTree *)malloc(total * sizeof(BiTree));
+    stk = (BiTree *)malloc(total * sizeof(BiTree));
+    if (nodes == NULL || stk == NULL) {
+        printf("错误！内存分配失败\n");
+        exit(1);
+    }
+    // 中序收集节点指针（显式栈）
+    while (p != NULL || top > 0) {
+        while (p != NULL) {
+            stk[top++] = p;
+            p = p->lchild;
+        }
+        p = stk[--top];
+        nodes[cnt++] = p;
+        p = p->rchild;
+    }
+    T = LinkTreap(nodes, cnt);
+    free(stk);
+    free(nodes);
+    return T;
+}
+
+// 由升序且不重复的key数组直接建treap
+BiTree CreateTreap(const int *keys, int cnt) {
+    BiTree *nodes, T;
+    int i;
+
+    if (cnt <= 0) return NULL;
+    nodes = (BiTree *)malloc(cnt * sizeof(BiTree));
+    if (nodes == NULL) {
+        printf("错误！内存分配失败\n");
+        exit(1);
+    }
+    for (i = 0; i < cnt; i++) {
+        nodes[i] = (BiTree)malloc(sizeof(BiNode));
+        if (nodes[i] == NULL) {
+            printf("错误！内存分配失败\n");
+            exit(1);
+        }
+        nodes[i]->data = keys[i];
+    }
+    T = LinkTreap(nodes, cnt);
+    free(nodes);
+    return T;
+}
+
+// 集合运算类型
+typedef enum { SETOP_UNION, SETOP_INTERSECT, SETOP_DIFF } SetOpType;
+
+static BiTree SetOpRec(SetOpType op, BiTree A, BiTree B, int depth);
+
+// 线程参数：在子线程里计算一个子问题
+typedef struct {
+    SetOpType op;
+    BiTree A, B, res;
+    int depth;
+} SetOpTask;
+
+static void *SetOpThread(void *arg) {
+    SetOpTask *t = (SetOpTask *)arg;
+    t->res = SetOpRec(t->op, t->A, t->B, t->depth);
+    return NULL;
+}
+
+// 分别计算左右两个子问题：规模够大且层数未超限时左半边交给新线程
+static void SetOpFork(SetOpType op, BiTree A1, BiTree B1, BiTree A2, BiTree B2,
+                      int depth, BiTree *res1, BiTree *res2) {
+    SetOpTask task = {op, A1, B1, NULL, depth + 1};
+    pthread_t tid;
+
+    if (depth < setop_fork_depth &&
+        SizeBST(A1) + SizeBST(B1) + SizeBST(A2) + SizeBST(B2) > SETOP_CUTOFF &&
+        pthread_create(&tid, NULL, SetOpThread, &task) == 0) {
+        *res2 = SetOpRec(op, A2, B2, depth + 1);
+        pthread_join(tid, NULL);
+        *res1 = task.res;
+    } else {
+        *res1 = SetOpRec(op, A1, B1, depth + 1);
+        *res2 = SetOpRec(op, A2, B2, depth + 1);
+    }
+}
+
+// 集合运算的统一递归：以一棵树的根拆分另一棵树，左右分别递归后再Join
+static BiTree SetOpRec(SetOpType op, BiTree A, BiTree B, int depth) {
+    BiTree L1, R1, dup, l, r, root;
+
+    switch (op) {
+        case SETOP_UNION:
+            if (A == NULL) return B;
+            if (B == NULL) return A;
+            // 以A的根拆B，B中与根重复的节点释放
+            SplitBST(B, A->data, &L1, &dup, &R1);
+            if (dup) free(dup);
+            SetOpFork(op, A->lchild, L1, A->rchild, R1, depth, &l, &r);
+            return JoinBST(l, A, r);
+
+        case SETOP_INTERSECT:
+            if (A == NULL || B == NULL) {
+                FreeBST(A);
+                FreeBST(B);
+                return NULL;
+            }
+            SplitBST(B, A->data, &L1, &dup, &R1);
+            root = A;
+            SetOpFork(op, root->lchild, L1, root->rchild, R1, depth, &l, &r);
+            if (dup) {            // 根在两棵树中都出现，保留A的节点
+                free(dup);
+                return JoinBST(l, root, r);
+            }
+            free(root);
+            return Join2BST(l, r);
+
+        case SETOP_DIFF:
+            if (A == NULL) {
+                FreeBST(B);
+                return NULL;
+            }
+            if (B == NULL) return A;
+            // 以B的根拆A，A中等于该key的节点被删掉
+            SplitBST(A, B->data, &L1, &dup, &R1);
+            if (dup) free(dup);
+            root = B;
+            SetOpFork(op, L1, root->lchild, R1, root->rchild, depth, &l, &r);
+            free(root);
+            return Join2BST(l, r);
+    }
+    return NULL;
+}
+
+// 设置集合运算使用的线程数（1表示串行），递归前几层按2的幂分叉
+void SetOpThreads(int threads) {
+    setop_fork_depth = 0;
+    while ((1 << setop_fork_depth) < threads) setop_fork_depth++;
+    if (threads > 1) setop_fork_depth++;  // 多分一层，缓解左右规模不均
+}
+
+// 三种集合运算：输入必须是treap（CreateTreap/BalanceBST的结果），A、B都会被消耗
+BiTree UnionBST(BiTree A, BiTree B) {
+    return SetOpRec(SETOP_UNION, A, B, 0);
+}
+
+BiTree IntersectBST(BiTree A, BiTree B) {
+    return SetOpRec(SETOP_INTERSECT, A, B, 0);
+}
+
+BiTree DifferenceBST(BiTree A, BiTree B) {
+    return SetOpRec(SETOP_DIFF, A, B, 0);
+}
+
+// ====================== 伸展树（splay）模式 ======================
+// 与InsertBST/SearchBST/FindDeleteBST对应的一组接口，节点结构相同（size域照常维护，
+// Select/Rank仍可用）。每次访问都把目标节点自顶向下伸展到根，热点key会停留在根附近，
+// 适合访问分布很不均匀的场景；代价是查找也会修改树，所以查找接口要传根指针的地址。
+
+// 自顶向下伸展：把key所在节点（不存在时为查找路径上最后一个节点）调整为根
+BiTree SplayBST(BiTree T, int key) {
+    BiNode N;                  // 临时头节点：N.rchild挂左树（<key），N.lchild挂右树（>key）
+    BiTree l, r, y;
+    int l_size = 0, r_size = 0;  // 左树、右树中已挂上的节点数
+
+    if (T == NULL) return NULL;
+    N.lchild = N.rchild = NULL;
+    l = r = &N;
+    for (;;) {
+        if (key < T->data) {
+            if (T->lchild == NULL) break;
+            if (key < T->lchild->data) {     // 一字型：先右旋
+                y = T->lchild;
+                T->lchild = y->rchild;
+                y->rchild = T;
+                UpdateSize(T);
+                T = y;
+                if (T->lchild == NULL) break;
+            }
+            r->lchild = T;                   // 当前根连同右子树挂到右树最左端
+            r = T;
+            T = T->lchild;
+            r_size += 1 + SizeBST(r->rchild);
+        } else if (key > T->data) {
+            if (T->rchild == NULL) break;
+            if (key > T->rchild->data) {     // 一字型：先左旋
+                y = T->rchild;
+                T->rchild = y->lchild;
+                y->lchild = T;
+                UpdateSize(T);
+                T = y;
+                if (T->rchild == NULL) break;
+            }
+            l->rchild = T;                   // 当前根连同左子树挂到左树最右端
+            l = T;
+            T = T->rchild;
+            l_size += 1 + SizeBST(l->lchild);
+        } else {
+            break;
+        }
+    }
+    // 左树/右树最终还要接上T原来的左右子树
+    l_size += SizeBST(T->lchild);
+    r_size += SizeBST(T->rchild);
+    T->size = l_size + r_size + 1;
+    l->rchild = r->lchild = NULL;
+    // 左树右脊、右树左脊上的节点子树大小都变了，自上而下修正
+    for (y = N.rchild; y != NULL; y = y->rchild) {
+        y->size = l_size;
+        l_size -= 1 + SizeBST(y->lchild);
+    }
+    for (y = N.lchild; y != NULL; y = y->lchild) {
+        y->size = r_size;
+        r_size -= 1 + SizeBST(y->rchild);
+    }
+    // 重新组装：左树、右树分别成为新根的左右子树
+    l->rchild = T->lchild;
+    r->lchild = T->rchild;
+    T->lchild = N.rchild;
+    T->rchild = N.lchild;
+    return T;
+}
+
+// 伸展树查找：找到时该节点被伸展到根，返回该节点；找不到返回NULL（树仍会被调整）
+BiTree SearchSplay(BiTree *T, int key) {
+    *T = SplayBST(*T, key);
+    return (*T != NULL && (*T)->data == key) ? *T : NULL;
+}
+
+// 伸展树插入：先伸展，再把新节点作为根，原树按key分到两侧；重复key不插入
+BiTree InsertSplay(BiTree T, int key) {
+    BiTree p;
+
+    if (T != NULL) {
+        T = SplayBST(T, key);
+        if (T->data == key) return T;
+    }
+    p = (BiTree)malloc(sizeof(BiNode));
+    if (p == NULL) {
+        printf("错误！内存分配失败\n");
+        exit(1);
+    }
+    p->data = key;
+    if (T == NULL) {
+        p->lchild = p->rchild = NULL;
+    } else if (key < T->data) {
+        p->lchild = T->lchild;   // 根比key大：根及其右子树成为新节点的右子树
+        p->rchild = T;
+        T->lchild = NULL;
+        UpdateSize(T);
+    } else {
+        p->rchild = T->rchild;   // 根比key小：根及其左子树成为新节点的左子树
+        p->lchild = T;
+        T->rchild = NULL;
+        UpdateSize(T);
+    }
+    UpdateSize(p);
+    return p;
+}
+
+// 伸展树删除：把key伸展到根后删掉根，再把左子树的最大值伸展上来接管右子树
+Status DeleteSplay(BiTree *T, int key) {
+    BiTree x;
+
+    if (*T == NULL) return 0;
+    *T = SplayBST(*T, key);
+    if ((*T)->data != key) return 0;  // 没找到
+    if ((*T)->lchild == NULL) {
+        x = (*T)->rchild;
+    } else {
+        // 左子树所有key都小于key，伸展后其最大值成为根且右子树为空
+        x = SplayBST((*T)->lchild, key);
+        x->rchild = (*T)->rchild;
+        UpdateSize(x);
+    }
+    free(*T);
+    *T = x;
+    return 1;
+}
+
+// 由数组逐个插入构建伸展树
+BiTree CreateSplay(int *num, int n) {
+    BiTree T = NULL;
+    for (int i = 0; i < n; i++) {
+        T = InsertSplay(T, num[i]);
+    }
+    return T;
+}
+
+// ====================== 性能测试（命令行：bench [n]） ======================
+// 简单的xorshift随机数（Windows下rand()最大只有32767，不够生成大量不重复的key）
+static unsigned long long bench_seed = 88172645463325252ULL;
+static unsigned int BenchRand(void) {
+    bench_seed ^= bench_seed << 13;
+    bench_seed ^= bench_seed >> 7;
+    bench_seed ^= bench_seed << 17;
+    return (unsigned int)(bench_seed >> 32);
+}
+
+// 毫秒计时（墙上时间；clock()在部分平台上统计的是所有线程的CPU时间，不适合测并行）
+static double NowMs(void) {
+#ifdef _WIN32
+    LARGE_INTEGER freq, now;
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&now);
+    return (double)now.QuadPart * 1000.0 / (double)freq.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+#endif
+}
+
+static double ElapsedMs(double begin) {
+    return NowMs() - begin;
+}
+
+// 对照组：不用size域，靠中序遍历数到第k个节点
+static BiTree SelectByInOrder(BiTree T, int *k) {
+    BiTree res;
+    if (T == NULL) return NULL;
+    if ((res = SelectByInOrder(T->lchild, k)) != NULL) return res;
+    if (--(*k) == 0) return T;
+    return SelectByInOrder(T->rchild, k);
+}
+
+// 对照组：原来的递归遍历 + 每个节点一次fprintf
+static void InOrderPrintf(BiTree T, FILE *fp) {
+    if (T != NULL) {
+        InOrderPrintf(T->lchild, fp);
+        fprintf(fp, "%d\n", T->data);
+        InOrderPrintf(T->rchild, fp);
+    }
+}
+
+// 按order把整棵树写到fp（每行一个key），返回写出的字节数
+static long long DumpByIter(BiTree T, IterOrder order, FILE *fp) {
+    static KeySink sink;
+    static int batch[4096];
+    long long bytes = 0;
+    int cnt;
+    BSTIter it;
+
+    SinkInit(&sink, fp);
+    InitIter(&it, T, order);
+    while ((cnt = NextBatch(&it, batch, 4096)) > 0) {
+        SinkPutKeys(&sink, batch, cnt, 0, '\n');
+        if (sink.len > SINK_SIZE / 2) {
+            bytes += sink.len;
+            SinkFlush(&sink);
+        }
+    }
+    FreeIter(&it);
+    bytes += sink.len;
+    SinkFlush(&sink);
+    return bytes;
+}
+
+// 中序导出整棵树的吞吐：printf递归 vs 显式栈迭代器 vs Morris迭代器
+static void BenchDump(BiTree T, const char *path) {
+    FILE *fp;
+    long long bytes;
+    double ms;
+    double t0;
+    IterOrder orders[] = {ITER_IN, ITER_MORRIS_IN, ITER_PRE, ITER_POST};
+    const char *names[] = {"中序(显式栈)", "中序(Morris)", "前序(显式栈)", "后序(显式栈)"};
+    int i;
+
+    fp = path ? fopen(path, "wb") : tmpfile();
+    if (fp == NULL) {
+        printf("无法打开导出文件，跳过导出测试\n");
+        return;
+    }
+    t0 = NowMs();
+    InOrderPrintf(T, fp);
+    fflush(fp);
+    ms = ElapsedMs(t0);
+    bytes = ftell(fp);
+    printf("递归+fprintf中序导出：%.1f ms，%.1f MB/s\n", ms, bytes / 1048576.0 / (ms / 1000));
+
+    for (i = 0; i < 4; i++) {
+        rewind(fp);
+        t0 = NowMs();
+        bytes = DumpByIter(T, orders[i], fp);
+        fflush(fp);
+        ms = ElapsedMs(t0);
+        printf("%s+批量输出：%.1f ms，%.1f MB/s\n", names[i], ms, bytes / 1048576.0 / (ms / 1000));
+    }
+    fclose(fp);
+}
+
+// 生成cnt个随机key，排序去重后返回实际个数
+static int CompareInt(const void *a, const void *b) {
+    int x = *(const int *)a, y = *(const int *)b;
+    return (x > y) - (x < y);
+}
+
+static int RandomSortedKeys(int *keys, int cnt, unsigned int range) {
+    int i, k = 0;
+    for (i = 0; i < cnt; i++) keys[i] = (int)(BenchRand() % range);
+    qsort(keys, cnt, sizeof(int), CompareInt);
+    for (i = 0; i < cnt; i++) {
+        if (k == 0 || keys[i] != keys[k - 1]) keys[k++] = keys[i];
+    }
+    return k;
+}
+
+// 集合运算：逐个插入求并 vs join式串行/并行
+static void BenchSetOps(int total, int threads) {
+    int *ka, *kb, *batch, na, nb, i, t, cnt;
+    int cnts[2];
+    BiTree A, B, R;
+    BSTIter it;
+    double t0;
+    double ms;
+    const char *names[] = {"并集", "交集", "差集"};
+
+    ka = (int *)malloc(total * sizeof(int));
+    kb = (int *)malloc(total * sizeof(int));
+    batch = (int *)malloc(4096 * sizeof(int));
+    if (ka == NULL || kb == NULL || batch == NULL) {
+        printf("内存不足，跳过集合运算测试\n");
+        free(ka);
+        free(kb);
+        free(batch);
+        return;
+    }
+    // 取值范围为2n，两个集合大约一半重叠
+    na = RandomSortedKeys(ka, total, (unsigned int)total * 2u);
+    nb = RandomSortedKeys(kb, total, (unsigned int)total * 2u);
+    printf("\n===== 集合运算：|A|=%d |B|=%d =====\n", na, nb);
+
+    // 对照：把B的key逐个InsertBST到A
+    A = CreateTreap(ka, na);
+    B = CreateTreap(kb, nb);
+    t0 = NowMs();
+    InitIter(&it, B, ITER_PRE);
+    while ((cnt = NextBatch(&it, batch, 4096)) > 0) {
+        for (i = 0; i < cnt; i++) A = InsertBST(A, batch[i]);
+    }
+    FreeIter(&it);
+    printf("逐个插入求并集：%.1f ms（结果%d个）\n", ElapsedMs(t0), SizeBST(A));
+    FreeBST(A);
+    FreeBST(B);
+
+    cnts[0] = 1;
+    cnts[1] = threads;
+    for (t = 0; t < (threads > 1 ? 2 : 1); t++) {
+        SetOpThreads(cnts[t]);
+        for (i = 0; i < 3; i++) {
+            A = CreateTreap(ka, na);
+            B = CreateTreap(kb, nb);
+            t0 = NowMs();
+            if (i == 0) R = UnionBST(A, B);
+            else if (i == 1) R = IntersectBST(A, B);
+            else R = DifferenceBST(A, B);
+            ms = ElapsedMs(t0);
+            printf("join式%s（%d线程）：%.1f ms（结果%d个）\n", names[i], cnts[t], ms, SizeBST(R));
+            FreeBST(R);
+        }
+    }
+    SetOpThreads(1);
+    free(ka);
+    free(kb);
+    free(batch);
+}
+
+// 查找路径上经过的节点数（找到的节点也计入）
+static int TouchedDepth(BiTree T, int key) {
+    int d = 0;
+    while (T != NULL) {
+        d++;
+        if (key == T->data) break;
+        T = (key < T->data) ? T->lchild : T->rchild;
+    }
+    return d;
+}
+
+// 倾斜访问：按Zipf分布回放查找，比较普通BST、treap和伸展树
+static void BenchSplay(int total) {
+    int *keys, *order, *ins, *queries, cnt, i, j, q = 2000000, tmp;
+    double *cdf, sum = 0, u, ms, t0;
+    long long depth, hits;
+    BiTree plain = NULL, treap, splay = NULL;
+    unsigned int hot = 0;
+
+    keys = (int *)malloc(total * sizeof(int));
+    order = (int *)malloc(total * sizeof(int));
+    ins = (int *)malloc(total * sizeof(int));
+    queries = (int *)malloc(q * sizeof(int));
+    cdf = (double *)malloc(total * sizeof(double));
+    if (keys == NULL || order == NULL || ins == NULL || queries == NULL || cdf == NULL) {
+        printf("内存不足，跳过伸展树测试\n");
+        free(keys);
+        free(order);
+        free(ins);
+        free(queries);
+        free(cdf);
+        return;
+    }
+    cnt = RandomSortedKeys(keys, total, (unsigned int)total * 4u);
+
+    // 随机打乱作为“热度排名”：order[0]最热（插入顺序另外打乱，与热度无关）
+    for (i = 0; i < cnt; i++) order[i] = keys[i];
+    for (i = cnt - 1; i > 0; i--) {
+        j = (int)(BenchRand() % (unsigned int)(i + 1));
+        tmp = order[i];
+        order[i] = order[j];
+        order[j] = tmp;
+    }
+    // Zipf(s=1)：第r热的key被访问的概率正比于1/r
+    for (i = 0; i < cnt; i++) {
+        sum += 1.0 / (i + 1);
+        cdf[i] = sum;
+    }
+    for (i = 0; i < q; i++) {
+        int lo = 0, hi = cnt - 1;
+        u = (BenchRand() / 4294967296.0) * sum;
+        while (lo < hi) {           // 二分找第一个cdf>=u的名次
+            int mid = (lo + hi) / 2;
+            if (cdf[mid] < u) lo = mid + 1;
+            else hi = mid;
+        }
+        if (lo < cnt / 5) hot++;
+        queries[i] = order[lo];
+    }
+    printf("\n===== 倾斜访问（Zipf s=1）：%d个key，%d次查找，前20%%热点占%.1f%%的访问 =====\n",
+           cnt, q, hot * 100.0 / q);
+
+    for (i = 0; i < cnt; i++) ins[i] = order[i];
+    for (i = cnt - 1; i > 0; i--) {
+        j = (int)(BenchRand() % (unsigned int)(i + 1));
+        tmp = ins[i];
+        ins[i] = ins[j];
+        ins[j] = tmp;
+    }
+    for (i = 0; i < cnt; i++) {
+        plain = InsertBST(plain, ins[i]);
+        splay = InsertSplay(splay, ins[i]);
+    }
+    treap = CreateTreap(keys, cnt);
+
+    // 普通BST与treap结构不变，经过的节点数可以单独统计
+    t0 = NowMs();
+    for (i = 0, hits = 0; i < q; i++) hits += SearchBST(plain, queries[i]) != NULL;
+    ms = ElapsedMs(t0);
+    for (i = 0, depth = 0; i < q; i++) depth += TouchedDepth(plain, queries[i]);
+    printf("普通BST：%.1f ns/次，平均经过%.2f个节点（命中%lld）\n", ms * 1e6 / q, (double)depth / q, hits);
+
+    t0 = NowMs();
+    for (i = 0, hits = 0; i < q; i++) hits += SearchBST(treap, queries[i]) != NULL;
+    ms = ElapsedMs(t0);
+    for (i = 0, depth = 0; i < q; i++) depth += TouchedDepth(treap, queries[i]);
+    printf("treap：  %.1f ns/次，平均经过%.2f个节点（命中%lld）\n", ms * 1e6 / q, (double)depth / q, hits);
+
+    // 伸展树每次查找都会改变形状：先计时，再在同样初始形状的树上按同一序列统计深度
+    t0 = NowMs();
+    for (i = 0, hits = 0; i < q; i++) hits += SearchSplay(&splay, queries[i]) != NULL;
+    ms = ElapsedMs(t0);
+    FreeBST(splay);
+    splay = NULL;
+    for (i = 0; i < cnt; i++) splay = InsertSplay(splay, ins[i]);
+    for (i = 0, depth = 0; i < q; i++) {
+        depth += TouchedDepth(splay, queries[i]);
+        SearchSplay(&splay, queries[i]);
+    }
+    printf("伸展树： %.1f ns/次，平均经过%.2f个节点（命中%lld）\n", ms * 1e6 / q, (double)depth / q, hits);
+
+    FreeBST(plain);
+    FreeBST(treap);
+    FreeBST(splay);
+    free(keys);
+    free(order);
+    free(ins);
+    free(queries);
+    free(cdf);
+}
+
+// 随机插入n个key后，比较Select/Rank与中序遍历求百分位数的耗时
+int RunBenchmark(int total, const char *dump_path, int threads) {
+    BiTree T = NULL;
+    int i, cnt, q = 1000000;
+    double pct[] = {0.01, 0.25, 0.50, 0.75, 0.90, 0.99};
+    long long check = 0;
+    double t0;
+
+    printf("===== 顺序统计性能测试：n=%d =====\n", total);
+    t0 = NowMs();
+    for (i = 0; i < total; i++) {
+        T = InsertBST(T, (int)(BenchRand() >> 1));
+    }
+    cnt = SizeBST(T);  // 随机key可能有重复，以实际节点数为准
+    printf("插入%d个key（去重后%d个）：%.1f ms\n", total, cnt, ElapsedMs(t0));
+    if (cnt == 0) return 0;
+
+    // 百分位数：Select直接按名次下行
+    for (i = 0; i < 6; i++) {
+        int k = (int)(pct[i] * cnt) + 1;
+        if (k > cnt) k = cnt;
+        printf("P%-3.0f = %d\n", pct[i] * 100, Select(T, k)->data);
+    }
+
+    t0 = NowMs();
+    for (i = 0; i < q; i++) {
+        check += Select(T, (int)(BenchRand() % (unsigned)cnt) + 1)->data;
+    }
+    printf("Select：%d次随机查询 %.1f ns/次\n", q, ElapsedMs(t0) * 1e6 / q);
+
+    t0 = NowMs();
+    for (i = 0; i < q; i++) {
+        check += Rank(T, (int)(BenchRand() >> 1));
+    }
+    printf("Rank：  %d次随机查询 %.1f ns/次\n", q, ElapsedMs(t0) * 1e6 / q);
+
+    // 对照：中序遍历求中位数（只做几次，代价是O(n)）
+    t0 = NowMs();
+    for (i = 0; i < 5; i++) {
+        int k = cnt / 2 + 1;
+        check += SelectByInOrder(T, &k)->data;
+    }
+    printf("中序遍历求中位数：%.1f ms/次\n", ElapsedMs(t0) / 5);
+    printf("（校验和：%lld）\n", check);
+
+    BenchDump(T, dump_path);
+    FreeBST(T);
+
+    BenchSetOps(total, threads);
+    BenchSplay(total);
+    return 0;
+}
+
 // 主函数：测试二叉排序树的构建、遍历和删除功能
-int main() {
+int main(int argc, char *argv[]) {
     INIT_UTF8_CONSOLE();
+    // 命令行带bench参数时只跑性能测试，例如：BinarySortTree_program bench 10000000 [导出文件] [线程数]
+    // 不指定导出文件时写入临时文件（传"-"也表示临时文件）
+    if (argc > 1 && strcmp(argv[1], "bench") == 0) {
+        return RunBenchmark(argc > 2 ? atoi(argv[2]) : 1000000,
+                            argc > 3 && strcmp(argv[3], "-") != 0 ? argv[3] : NULL,
+                            argc > 4 ? atoi(argv[4]) : 4);
+    }
     int a;
     printf("所有原始数据为：\n");
     show_num(20, num);  // 输出原始数组
@@ -183,6 +1206,39 @@ int main() {
     PostOrder(T);
     printf("\n");
 
+    // 顺序统计：第k小与名次查询（不需要遍历）
+    printf("共%d个节点，中位数（第%d小）：%d，最小值：%d，最大值：%d\n",
+           SizeBST(T), (SizeBST(T) + 1) / 2, Select(T, (SizeBST(T) + 1) / 2)->data,
+           Select(T, 1)->data, Select(T, SizeBST(T))->data);
+    printf("关键字 %d 的名次：%d\n", num[0], Rank(T, num[0]));
+
+    // 集合运算：另取两棵树，平衡成treap后求并、交、差
+    int num2[] = {45, 3, 60, 17, 99, 53, 8, 77, 21, 85};
+    printf("另一组数据为：\n");
+    show_num(10, num2);
+    printf("\n并集：");
+    BiTree U = UnionBST(BalanceBST(CreateBST(num, 20)), BalanceBST(CreateBST(num2, 10)));
+    InOrder(U);
+    printf("\n交集：");
+    BiTree I = IntersectBST(BalanceBST(CreateBST(num, 20)), BalanceBST(CreateBST(num2, 10)));
+    InOrder(I);
+    printf("\n差集：");
+    BiTree D = DifferenceBST(BalanceBST(CreateBST(num, 20)), BalanceBST(CreateBST(num2, 10)));
+    InOrder(D);
+    printf("\n");
+    FreeBST(U);
+    FreeBST(I);
+    FreeBST(D);
+
+    // 伸展树：查找过的key会被调整到根
+    BiTree S = CreateSplay(num, 20);
+    SearchSplay(&S, 4);
+    SearchSplay(&S, 4);
+    printf("伸展树连续查找4后，根节点：%d，中序：", S->data);
+    InOrder(S);
+    printf("\n");
+    FreeBST(S);
+
     //  删除指定元素（输入序号，1~20对应数组第1~20个元素）
     printf("请输入要删除的元素序号（1-20）：\n");
     scanf("%d", &a);
@@ -195,6 +1251,7 @@ int main() {
     if (FindDeleteBST(&T, num[a - 1])) {
         printf("删除元素 %d 后，中序遍历结果（有序）：\n", num[a - 1]);
         InOrder(T);
+        printf("\n剩余%d个节点，中位数：%d\n", SizeBST(T), Select(T, (SizeBST(T) + 1) / 2)->data);
     } else {
         printf("删除失败：未找到该元素！\n");
     }
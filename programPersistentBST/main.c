@@ -0,0 +1,482 @@
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+#include<time.h>
+#include<pthread.h>
+#include<stdatomic.h>
+#include "../utf8support.h"
+
+// 持久化（路径复制）二叉排序树：
+// 每次插入/删除不修改任何已有节点，只复制根到修改点路径上的节点，
+// 没改动的子树由新旧版本共享。写完后原子地发布新根，读者拿到某个根之后
+// 看到的就是一个永远不会变的版本，全程不加锁。
+// 内存回收：节点带引用计数（被多少个父节点/版本根引用）；读者短时间“钉住”
+// 根只登记当前纪元（epoch），不碰引用计数；写者把被替换下来的旧根挂到待回收
+// 链表上，等所有可能看到它的读者都离开后再释放引用，未共享的路径节点随之释放。
+
+// 给定的20个整数数据（与programBST相同）
+int num[] = {57, 45, 75, 53, 17, 85, 14, 73, 34, 77, 50, 4, 44, 15, 60, 78, 90, 49, 98, 59};
+typedef int Status;
+
+#define MAX_READERS 64   // 最多同时登记的读者线程数
+
+// 持久化树节点：发布后只读，只有引用计数会变化
+typedef struct PNode {
+    int data;                 // 关键字
+    atomic_int ref;           // 引用计数：父节点数 + 以它为根的版本数
+    struct PNode *lchild;     // 左子树（可能与其他版本共享）
+    struct PNode *rchild;     // 右子树
+} PNode;
+
+// 待回收的旧版本根
+typedef struct Retired {
+    PNode *root;                  // 被替换下来的旧根（持有一份版本引用）
+    unsigned long long epoch;     // 替换时的纪元
+    struct Retired *next;
+} Retired;
+
+// 持久化树：当前版本根 + 纪元回收状态
+typedef struct {
+    _Atomic(PNode *) root;                          // 当前版本根（持有一份版本引用）
+    pthread_mutex_t write_lock;                     // 多个写者之间互斥（读者不用）
+    atomic_ullong epoch;                            // 全局纪元，从1开始
+    atomic_ullong reader_epoch[MAX_READERS];        // 各读者钉住时的纪元，0表示未钉住
+    atomic_int reader_count;                        // 已登记的读者数
+    Retired *retired;                               // 待回收链表（持有写锁时访问）
+    int retired_count;
+} PTree;
+
+// 函数声明
+void InitPTree(PTree *t);                        // 初始化空树
+void DestroyPTree(PTree *t);                     // 销毁树（调用时不能有读者）
+Status InsertPBST(PTree *t, int key);            // 插入（发布新版本）
+Status FindDeletePBST(PTree *t, int key);        // 删除（发布新版本）
+int RegisterReader(PTree *t);                    // 登记读者，返回槽位号
+PNode *PinRoot(PTree *t, int slot);              // 钉住当前版本
+void UnpinRoot(PTree *t, int slot);              // 结束本次读
+PNode *TakeSnapshot(PTree *t, int slot);         // 长期持有的快照（引用计数）
+void ReleaseSnapshot(PNode *root);               // 释放快照
+PNode *SearchPBST(PNode *root, int key);         // 在某个版本中查找
+
+// ====================== 节点与引用计数 ======================
+// 新建节点，引用计数为1（归调用者所有）；孩子的引用由调用者负责
+static PNode *NewPNode(int data, PNode *l, PNode *r) {
+    PNode *p = (PNode *)malloc(sizeof(PNode));
+    if (p == NULL) {
+        printf("错误！内存分配失败\n");
+        exit(1);
+    }
+    p->data = data;
+    atomic_init(&p->ref, 1);
+    p->lchild = l;
+    p->rchild = r;
+    return p;
+}
+
+// 共享已有子树：多一个引用者
+static PNode *Share(PNode *p) {
+    if (p != NULL) atomic_fetch_add_explicit(&p->ref, 1, memory_order_relaxed);
+    return p;
+}
+
+// 释放一个引用：减到0时释放节点并继续释放它对孩子的引用
+// 只有未共享的节点会被释放，用小栈暂存右孩子，一般不需要递归
+static void Release(PNode *p) {
+    PNode *stack[128], *l, *r;
+    int top = 0;
+
+    while (p != NULL || top > 0) {
+        if (p == NULL) p = stack[--top];
+        if (atomic_fetch_sub_explicit(&p->ref, 1, memory_order_acq_rel) != 1) {
+            p = NULL;        // 还有别的引用者
+            continue;
+        }
+        l = p->lchild;
+        r = p->rchild;
+        free(p);
+        // 先处理左孩子，右孩子暂存（栈满时才递归处理）
+        if (r != NULL) {
+            if (top < 128) stack[top++] = r;
+            else Release(r);
+        }
+        p = l;
+    }
+}
+
+// ====================== 纪元（epoch）回收 ======================
+void InitPTree(PTree *t) {
+    int i;
+    atomic_init(&t->root, NULL);
+    pthread_mutex_init(&t->write_lock, NULL);
+    atomic_init(&t->epoch, 1);
+    for (i = 0; i < MAX_READERS; i++) atomic_init(&t->reader_epoch[i], 0);
+    atomic_init(&t->reader_count, 0);
+    t->retired = NULL;
+    t->retired_count = 0;
+}
+
+// 登记一个读者线程，返回它专用的槽位；超过上限返回-1
+int RegisterReader(PTree *t) {
+    int slot = atomic_fetch_add(&t->reader_count, 1);
+    return slot < MAX_READERS ? slot : -1;
+}
+
+// 钉住当前版本：先公布自己所在的纪元，再读根。钉住期间拿到的版本不会被回收
+PNode *PinRoot(PTree *t, int slot) {
+    atomic_store(&t->reader_epoch[slot], atomic_load(&t->epoch));
+    return atomic_load(&t->root);
+}
+
+void UnpinRoot(PTree *t, int slot) {
+    atomic_store_explicit(&t->reader_epoch[slot], 0, memory_order_release);
+}
+
+// 长期快照：在钉住期间给根加一份引用，之后不再依赖纪元，用完调用ReleaseSnapshot
+PNode *TakeSnapshot(PTree *t, int slot) {
+    PNode *root = Share(PinRoot(t, slot));
+    UnpinRoot(t, slot);
+    return root;
+}
+
+void ReleaseSnapshot(PNode *root) {
+    Release(root);
+}
+
+// 回收所有安全的旧版本：替换纪元小于所有活跃读者纪元的旧根（持有写锁时调用）
+static void Reclaim(PTree *t) {
+    unsigned long long min_epoch = ~0ULL, e;
+    int i, readers = atomic_load(&t->reader_count);
+    Retired **pp = &t->retired, *r;
+
+    if (readers > MAX_READERS) readers = MAX_READERS;
+    for (i = 0; i < readers; i++) {
+        e = atomic_load(&t->reader_epoch[i]);
+        if (e != 0 && e < min_epoch) min_epoch = e;
+    }
+    while ((r = *pp) != NULL) {
+        // 读者公布的纪元<=r->epoch时，它可能是在旧根被替换之前读到的根
+        if (r->epoch < min_epoch) {
+            *pp = r->next;
+            Release(r->root);
+            free(r);
+            t->retired_count--;
+        } else {
+            pp = &r->next;
+        }
+    }
+}
+
+// 发布新版本：原子替换根，推进纪元，旧根进入待回收链表（持有写锁时调用）
+static void Publish(PTree *t, PNode *new_root) {
+    PNode *old = atomic_exchange(&t->root, new_root);
+    Retired *r;
+
+    if (old != NULL) {
+        r = (Retired *)malloc(sizeof(Retired));
+        if (r == NULL) {
+            printf("错误！内存分配失败\n");
+            exit(1);
+        }
+        r->root = old;
+        r->epoch = atomic_fetch_add(&t->epoch, 1);
+        r->next = t->retired;
+        t->retired = r;
+        t->retired_count++;
+    }
+    Reclaim(t);
+}
+
+// 销毁整棵树（调用时不能再有读者）
+void DestroyPTree(PTree *t) {
+    Retired *r;
+    while ((r = t->retired) != NULL) {
+        t->retired = r->next;
+        Release(r->root);
+        free(r);
+    }
+    t->retired_count = 0;
+    Release(atomic_exchange(&t->root, NULL));
+    pthread_mutex_destroy(&t->write_lock);
+}
+
+// ====================== 路径复制的插入与删除 ======================
+// 从path[k-1]开始自下而上复制路径：cur是path[k]所在位置的新子树，返回新根
+// path[0..k-1]是根到修改点的祖先，方向按key与祖先关键字比较确定
+static PNode *CopyPath(PNode **path, int k, int key, PNode *cur) {
+    PNode *p;
+    while (k-- > 0) {
+        p = path[k];
+        if (key < p->data) cur = NewPNode(p->data, cur, Share(p->rchild));
+        else cur = NewPNode(p->data, Share(p->lchild), cur);
+    }
+    return cur;
+}
+
+// 路径数组：按需扩容（树高没有上限）
+typedef struct {
+    PNode **node;
+    int len, cap;
+} PathBuf;
+
+static void PathPush(PathBuf *pb, PNode *p) {
+    if (pb->len == pb->cap) {
+        pb->cap = pb->cap ? pb->cap * 2 : 64;
+        pb->node = (PNode **)realloc(pb->node, pb->cap * sizeof(PNode *));
+        if (pb->node == NULL) {
+            printf("错误！内存分配失败\n");
+            exit(1);
+        }
+    }
+    pb->node[pb->len++] = p;
+}
+
+// 插入：key已存在时不产生新版本，返回0
+Status InsertPBST(PTree *t, int key) {
+    PathBuf pb = {NULL, 0, 0};
+    PNode *p;
+
+    pthread_mutex_lock(&t->write_lock);
+    p = atomic_load(&t->root);
+    while (p != NULL) {           // 记录根到插入位置的路径
+        if (key == p->data) {
+            pthread_mutex_unlock(&t->write_lock);
+            free(pb.node);
+            return 0;
+        }
+        PathPush(&pb, p);
+        p = (key < p->data) ? p->lchild : p->rchild;
+    }
+    Publish(t, CopyPath(pb.node, pb.len, key, NewPNode(key, NULL, NULL)));
+    pthread_mutex_unlock(&t->write_lock);
+    free(pb.node);
+    return 1;
+}
+
+// 删除：分叶子/单孩子/双孩子三种情况（与FindDeleteBST一致，双孩子时用左子树最大值替换）
+Status FindDeletePBST(PTree *t, int key) {
+    PathBuf pb = {NULL, 0, 0}, spine = {NULL, 0, 0};
+    PNode *p, *s, *repl, *left;
+    int i;
+
+    pthread_mutex_lock(&t->write_lock);
+    p = atomic_load(&t->root);
+    while (p != NULL && p->data != key) {
+        PathPush(&pb, p);
+        p = (key < p->data) ? p->lchild : p->rchild;
+    }
+    if (p == NULL) {              // 没找到，不产生新版本
+        pthread_mutex_unlock(&t->write_lock);
+        free(pb.node);
+        return 0;
+    }
+
+    if (p->lchild == NULL) {
+        repl = Share(p->rchild);  // 叶子或只有右子树
+    } else if (p->rchild == NULL) {
+        repl = Share(p->lchild);  // 只有左子树
+    } else {
+        // 左子树最大值s：沿右脊走到底，复制右脊并把s换成s的左子树
+        s = p->lchild;
+        while (s->rchild != NULL) {
+            PathPush(&spine, s);
+            s = s->rchild;
+        }
+        left = Share(s->lchild);
+        for (i = spine.len - 1; i >= 0; i--) {
+            left = NewPNode(spine.node[i]->data, Share(spine.node[i]->lchild), left);
+        }
+        repl = NewPNode(s->data, left, Share(p->rchild));
+    }
+    Publish(t, CopyPath(pb.node, pb.len, key, repl));
+    pthread_mutex_unlock(&t->write_lock);
+    free(pb.node);
+    free(spine.node);
+    return 1;
+}
+
+// ====================== 只读操作（对任意版本） ======================
+PNode *SearchPBST(PNode *root, int key) {
+    while (root != NULL && root->data != key) {
+        root = (key < root->data) ? root->lchild : root->rchild;
+    }
+    return root;
+}
+
+// 中序遍历（演示用）
+void InOrderP(PNode *T) {
+    if (T != NULL) {
+        InOrderP(T->lchild);
+        printf("%3d ", T->data);
+        InOrderP(T->rchild);
+    }
+}
+
+// ====================== 性能测试（命令行：bench [n] [读者数] [毫秒]） ======================
+static unsigned long long NextRand(unsigned long long *seed) {
+    *seed ^= *seed << 13;
+    *seed ^= *seed >> 7;
+    *seed ^= *seed << 17;
+    return *seed;
+}
+
+// 墙上时间（毫秒）
+static double NowMs(void) {
+#ifdef _WIN32
+    LARGE_INTEGER freq, now;
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&now);
+    return (double)now.QuadPart * 1000.0 / (double)freq.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+#endif
+}
+
+typedef struct {
+    PTree *tree;
+    int key_range;
+    atomic_int *stop;
+    long long ops;           // 读者：完成的查找数；写者：完成的更新数
+    long long hits;
+    unsigned long long seed;
+} BenchArg;
+
+// 读者：每钉住一次版本做64次查找
+static void *ReaderThread(void *arg) {
+    BenchArg *a = (BenchArg *)arg;
+    int slot = RegisterReader(a->tree), i;
+    PNode *root;
+
+    if (slot < 0) return NULL;
+    while (!atomic_load_explicit(a->stop, memory_order_relaxed)) {
+        root = PinRoot(a->tree, slot);
+        for (i = 0; i < 64; i++) {
+            a->hits += SearchPBST(root, (int)(NextRand(&a->seed) % (unsigned)a->key_range)) != NULL;
+        }
+        UnpinRoot(a->tree, slot);
+        a->ops += 64;
+    }
+    return NULL;
+}
+
+// 写者：随机插入/删除交替进行
+static void *WriterThread(void *arg) {
+    BenchArg *a = (BenchArg *)arg;
+    int key;
+
+    while (!atomic_load_explicit(a->stop, memory_order_relaxed)) {
+        key = (int)(NextRand(&a->seed) % (unsigned)a->key_range);
+        if (NextRand(&a->seed) & 1) InsertPBST(a->tree, key);
+        else FindDeletePBST(a->tree, key);
+        a->ops++;
+    }
+    return NULL;
+}
+
+// 跑一轮：readers个读者，with_writer表示是否同时有写者，返回读者总吞吐（次/秒）
+static double RunRound(PTree *t, int key_range, int readers, int with_writer, int ms,
+                       long long *writes) {
+    pthread_t tid[MAX_READERS + 1];
+    BenchArg args[MAX_READERS + 1];
+    atomic_int stop;
+    double t0, elapsed;
+    long long total = 0;
+    int i;
+
+    atomic_init(&stop, 0);
+    for (i = 0; i <= readers; i++) {
+        args[i].tree = t;
+        args[i].key_range = key_range;
+        args[i].stop = &stop;
+        args[i].ops = args[i].hits = 0;
+        args[i].seed = 0x9E3779B97F4A7C15ULL * (i + 1);
+    }
+    // 读者槽位按登记顺序分配，每轮重新登记前清零计数
+    atomic_store(&t->reader_count, 0);
+    t0 = NowMs();
+    for (i = 0; i < readers; i++) pthread_create(&tid[i], NULL, ReaderThread, &args[i]);
+    if (with_writer) pthread_create(&tid[readers], NULL, WriterThread, &args[readers]);
+    while (NowMs() - t0 < ms) {
+#ifdef _WIN32
+        Sleep(10);
+#else
+        struct timespec ts = {0, 10 * 1000 * 1000};
+        nanosleep(&ts, NULL);
+#endif
+    }
+    atomic_store(&stop, 1);
+    for (i = 0; i < readers; i++) pthread_join(tid[i], NULL);
+    if (with_writer) pthread_join(tid[readers], NULL);
+    elapsed = NowMs() - t0;
+    for (i = 0; i < readers; i++) total += args[i].ops;
+    *writes = with_writer ? args[readers].ops : 0;
+    return total / (elapsed / 1000.0);
+}
+
+int RunBenchmark(int total, int readers, int ms) {
+    PTree t;
+    unsigned long long seed = 88172645463325252ULL;
+    long long writes;
+    double base, loaded, t0;
+    int i, r;
+
+    if (readers < 1) readers = 1;
+    if (readers > MAX_READERS) readers = MAX_READERS;
+    InitPTree(&t);
+    t0 = NowMs();
+    for (i = 0; i < total; i++) InsertPBST(&t, (int)(NextRand(&seed) % (unsigned)(total * 2)));
+    printf("===== 持久化BST：随机插入%d个key：%.1f ms =====\n", total, NowMs() - t0);
+
+    // 读者数按1、2、4…翻倍，最后一轮正好是readers个
+    for (r = 1;; r = r * 2 < readers ? r * 2 : readers) {
+        base = RunRound(&t, total * 2, r, 0, ms, &writes);
+        loaded = RunRound(&t, total * 2, r, 1, ms, &writes);
+        printf("%2d个读者：无写者 %.2f M次/秒，有写者 %.2f M次/秒（%.1f%%），写者 %.1f K次更新/秒，待回收%d个版本\n",
+               r, base / 1e6, loaded / 1e6, loaded * 100.0 / base, writes / (ms / 1000.0) / 1e3,
+               t.retired_count);
+        if (r == readers) break;
+    }
+    DestroyPTree(&t);
+    return 0;
+}
+
+// 主函数：演示快照在后续删除/插入之后保持不变
+int main(int argc, char *argv[]) {
+    INIT_UTF8_CONSOLE();
+    // 例如：PersistentBST_program bench 1000000 8 1000
+    if (argc > 1 && strcmp(argv[1], "bench") == 0) {
+        return RunBenchmark(argc > 2 ? atoi(argv[2]) : 1000000,
+                            argc > 3 ? atoi(argv[3]) : 4,
+                            argc > 4 ? atoi(argv[4]) : 1000);
+    }
+
+    PTree T;
+    PNode *snap;
+    int i, slot;
+
+    InitPTree(&T);
+    for (i = 0; i < 20; i++) InsertPBST(&T, num[i]);
+    slot = RegisterReader(&T);
+
+    printf("当前版本中序遍历：\n");
+    InOrderP(PinRoot(&T, slot));
+    UnpinRoot(&T, slot);
+    printf("\n");
+
+    snap = TakeSnapshot(&T, slot);   // 保存一个快照
+    FindDeletePBST(&T, 57);          // 删除根（双孩子情况）
+    FindDeletePBST(&T, 4);           // 删除叶子
+    InsertPBST(&T, 66);
+
+    printf("删除57、4并插入66后的新版本：\n");
+    InOrderP(PinRoot(&T, slot));
+    UnpinRoot(&T, slot);
+    printf("\n快照版本（不受影响）：\n");
+    InOrderP(snap);
+    printf("\n快照中查找57：%s\n", SearchPBST(snap, 57) ? "找到" : "未找到");
+
+    ReleaseSnapshot(snap);
+    DestroyPTree(&T);
+    return 0;
+}
@@ -2,6 +2,7 @@
 #include "stdlib.h"
 #include "limits.h" //用于INT_MAX(最小权值初始化)
 #include "../utf8support.h"
+#include "../bytehist.h"
 
 //哈夫曼树节点结构体定义
 //采用数组存储哈夫曼树，节点包含权值、双亲/左右孩子索引
@@ -12,13 +13,32 @@ typedef struct{
     int rchild; //右孩子节点索引
 } HTNode,*Huffmantree;
 
+//小根堆辅助：堆中存(权值<<32|下标)，一次整数比较就是先比权值、再比下标
+static unsigned long long HeapKey(Huffmantree HT,int i){
+    return (unsigned long long)(unsigned int)HT[i].weight<<32|(unsigned int)i;
+}
+
+static void HeapSiftDown(unsigned long long heap[],int size,int i){
+    unsigned long long x=heap[i];
+    for(;;){
+        int c=2*i+1;
+        if(c>=size) break;
+        if(c+1<size&&heap[c+1]<heap[c]) c++;
+        if(heap[c]>=x) break;
+        heap[i]=heap[c];
+        i=c;
+    }
+    heap[i]=x;
+}
+
 //核心函数：构建哈夫曼树
 /**
  * @brief 构建哈夫曼树
  * @param HT 指向哈夫曼树数组的指针（二级指针，用于修改外部数据）
  * @param n 叶子节点的数量
+ * @param weights 叶子节点的权值（NULL表示从键盘输入）
  */
-void CreateHuffmanTree(Huffmantree *HT,int n){  //HuffmanTree *HT等价于HTNode **HT
+void CreateHuffmanTree(Huffmantree *HT,int n,const int *weights){  //HuffmanTree *HT等价于HTNode **HT
     //边界处理：小于两个叶子节点无法创建哈夫曼树
     if(n<=1){
         printf("错误！叶子节点数必须大于1！\n");
@@ -40,10 +60,16 @@ void CreateHuffmanTree(Huffmantree *HT,int n){  //HuffmanTree *HT等价于HTNode
         (*HT)[i].rchild=0;
     }
 
-    //步骤2：输入n个叶子节点的权值：
-    printf("请输入%d个叶子节点的权值（空格分隔）：\n",n);
+    //步骤2：输入n个叶子节点的权值（已给出weights时直接使用）：
+    if(weights==NULL){
+        printf("请输入%d个叶子节点的权值（空格分隔）：\n",n);
+    }
     for(int i=1;i<=n;i++){
-        scanf("%d",&(*HT)[i].weight);
+        if(weights!=NULL){
+            (*HT)[i].weight=weights[i-1];
+        }else{
+            scanf("%d",&(*HT)[i].weight);
+        }
         //简单校验：权值不能为负
         if((*HT)[i].weight<0){
             printf("错误：权值不能为负数！\n");
@@ -54,27 +80,26 @@ void CreateHuffmanTree(Huffmantree *HT,int n){  //HuffmanTree *HT等价于HTNode
     }
 
     //步骤3：构建n-1个非叶子节点（下标从n+1到m）
+    //用小根堆取两个最小权值节点：堆元素是(权值<<32|下标)，权值相同时下标小的优先，
+    //与逐个扫描1~i-1找最小、次小的结果完全相同，但每次合并只要O(log n)
+    unsigned long long *heap=(unsigned long long*)malloc(n*sizeof(unsigned long long));
+    int size=n;
+    if(heap==NULL){
+        printf("错误！内存分配失败\n");
+        exit(1);
+    }
+    for(int i=1;i<=n;i++){
+        heap[i-1]=HeapKey(*HT,i);
+    }
+    for(int i=n/2-1;i>=0;i--){
+        HeapSiftDown(heap,size,i);
+    }
     for(int i=n+1;i<=m;i++){
         //s1:最小权值节点下标   s2:次小权值节点下标
-        //min1:最小权值       min2:次小权值（初始值为INT_MAX,确保能被更新）
-        int s1=0,s2=0,min1=INT_MAX,min2=INT_MAX;
-
-        //遍历1~i-1的节点，找两个无父节点（未被合并）的最小权值节点
-        for(int j=1;j<i;j++){
-            if((*HT)[j].parent==0){ //仅考虑未被选过的节点
-                if((*HT)[j].weight<min1){
-                    //找到更小的权值：次小值＝原最小值，最小值=当前值
-                    min2=min1;
-                    s2=s1;
-                    min1=(*HT)[j].weight;
-                    s1=j;
-                } else if ((*HT)[j].weight<min2){
-                    //找到次小值时仅更新次小值
-                    min2=(*HT)[j].weight;
-                    s2=j;
-                }
-            }
-        }
+        int s1=(int)(heap[0]&0xFFFFFFFFu);
+        heap[0]=heap[--size];   //弹出最小
+        HeapSiftDown(heap,size,0);
+        int s2=(int)(heap[0]&0xFFFFFFFFu);   //次小留在堆顶，稍后被新节点i替换
 
         //步骤4：绑定父子关系（新节点i为s1,s2的父节点）
         (*HT)[s1].parent=i; //s1的父节点是i
@@ -82,11 +107,14 @@ void CreateHuffmanTree(Huffmantree *HT,int n){  //HuffmanTree *HT等价于HTNode
         (*HT)[i].lchild=s1; //i的左孩子是s1（习惯：小权值放左，大权值放右）
         (*HT)[i].rchild=s2; //i的右孩子是s2
         (*HT)[i].weight=(*HT)[s1].weight+(*HT)[s2].weight;
+        heap[0]=HeapKey(*HT,i);
+        HeapSiftDown(heap,size,0);
 
         //调试输出：打印每一步合并的节点
         printf("合并节点：%d(权值：%d)+%d(权值：%d)=节点%d(权值%d)\n",
                s1,(*HT)[s1].weight,s2,(*HT)[s2].weight,i,(*HT)[i].weight);
     }
+    free(heap);
 }
 
 //辅助函数：计算哈夫曼树的带权路径长度
@@ -158,18 +186,73 @@ void CreateHuffmanCode(Huffmantree HT,int n,char **code){
     free(tmp_code);
 }
 
+//拓展函数：以文件中各字节值的出现次数作为叶子权值（只取出现过的字节值，按字节值从小到大）
+/**
+ * @brief 统计文件的字节频率
+ * @param path 文件路径
+ * @param weights 输出：各叶子的权值
+ * @param bytes 输出：各叶子对应的字节值
+ * @return 叶子节点数量
+ */
+int FileWeights(const char *path,int weights[256],int bytes[256]){
+    FILE *fp=fopen(path,"rb");
+    unsigned char *buf=(unsigned char*)malloc(1<<20);
+    unsigned int count[256];
+    unsigned long long total[256]={0},sum=0;
+    size_t got;
+    int n=0;
+
+    if(fp==NULL||buf==NULL){
+        printf("错误！无法打开文件%s\n",path);
+        exit(1);
+    }
+    //每次读1MB，用字节直方图统计（见bytehist.h），再累加到总数
+    while((got=fread(buf,1,1<<20,fp))>0){
+        ByteHistogram(buf,got,count);
+        for(int c=0;c<256;c++){
+            total[c]+=count[c];
+        }
+        sum+=got;
+    }
+    fclose(fp);
+    free(buf);
+    //权值和WPL都用int存放：码长不超过255，文件不超过INT_MAX/256字节就不会溢出
+    if(sum>INT_MAX/256){
+        printf("错误！文件太大（最多%d字节）\n",INT_MAX/256);
+        exit(1);
+    }
+    for(int c=0;c<256;c++){
+        if(total[c]>0){
+            weights[n]=(int)total[c];
+            bytes[n]=c;
+            n++;
+        }
+    }
+    return n;
+}
+
 // ====================== 5. 主函数：测试哈夫曼树构建与使用 ======================
-int main() {
+// 不带参数时从键盘输入叶子数和权值；带一个文件名时以该文件各字节值的出现次数为权值
+int main(int argc, char *argv[]) {
     INIT_UTF8_CONSOLE();
     Huffmantree HT = NULL;  // 哈夫曼树数组
     int n;                  // 叶子节点数量
+    int weights[256], bytes[256];
 
-    // 步骤1：输入叶子节点数量
-    printf("请输入哈夫曼树的叶子节点数量：");
-    scanf("%d", &n);
+    // 步骤1：输入叶子节点数量（或统计文件的字节频率）
+    if (argc > 1) {
+        n = FileWeights(argv[1], weights, bytes);
+        printf("文件%s中出现了%d种字节值：\n", argv[1], n);
+        for (int i = 0; i < n; i++) {
+            printf("叶子节点%d：字节0x%02X，出现%d次\n", i + 1, bytes[i], weights[i]);
+        }
+    } else {
+        printf("请输入哈夫曼树的叶子节点数量：");
+        scanf("%d", &n);
+    }
 
     // 步骤2：构建哈夫曼树
-    CreateHuffmanTree(&HT, n);
+    CreateHuffmanTree(&HT, n, argc > 1 ? weights : NULL);
     if (HT == NULL) {  // 构建失败则退出
         return 1;
     }
@@ -1,7 +1,21 @@
 #include "stdio.h"
 #include "stdlib.h"
+#include "string.h"
+#include "stdint.h"
+#include "time.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#ifndef _WIN32
+#include <sched.h>
+#endif
 #include "../utf8support.h"
-#define MAXSIZE 100
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+#define MAXSIZE 128  // 队列初始容量（2的幂，满了自动翻倍）
 
 //1.定义二叉树节点结构体：
 typedef struct BiTNode{
@@ -10,22 +24,26 @@ typedef struct BiTNode{
     struct BiTNode *rchild;
 }BiTNode,*BiTree;
 
-//2.递归创建二叉树
-void CreateBiTree(BiTree* T){
+BiTree NewBiTNode(int val);   // 分配节点，并登记到当前的值索引（见第13节）
+
+//2.递归创建二叉树（从fp读入，CreateBiTree从标准输入读）
+void CreateBiTreeFrom(FILE *fp, BiTree* T){
     int val;
-    scanf("%d",&val);
-    if(val==-1){
+    if(fscanf(fp,"%d",&val)!=1 || val==-1){
         *T=NULL;
         return;
     }
 
     //分配当前节点内存
-    *T=(BiTree) malloc(sizeof(BiTNode));
-    (*T)->data=val;
+    *T=NewBiTNode(val);
     //递归创建左子树
-    CreateBiTree(&((*T)->lchild));
+    CreateBiTreeFrom(fp, &((*T)->lchild));
     //递归创建右子树
-    CreateBiTree(&((*T)->rchild));
+    CreateBiTreeFrom(fp, &((*T)->rchild));
+}
+
+void CreateBiTree(BiTree* T){
+    CreateBiTreeFrom(stdin, T);
 }
 
 //先序遍历：根->左->右
@@ -57,37 +75,58 @@ void PostOrder(BiTree T){
 
 //层序遍历
 //队列结构体，存二叉树节点指针
+//循环队列：容量为2的幂，下标用&mask取模；队满时容量翻倍，不再受MAXSIZE限制
 typedef struct {
-    BiTree data[MAXSIZE];
-    int front ,rear
+    BiTree *data;
+    size_t front, rear;   //只增不减，实际位置为 front&mask、rear&mask
+    size_t mask;          //容量-1
 }SqQueue;
 
 //队列初始化
 void InitQueue(SqQueue *q){
+    q->data=(BiTree*)malloc(MAXSIZE*sizeof(BiTree));
     q->front=q->rear=0;
+    q->mask=q->data?MAXSIZE-1:0;
+}
+
+//销毁队列，释放存储空间
+void DestroyQueue(SqQueue *q){
+    free(q->data);
+    q->data=NULL;
+    q->front=q->rear=q->mask=0;
 }
 
-// 4.3 入队
+// 4.3 入队（队满时扩容，只有内存分配失败才返回0）
 int EnQueue(SqQueue *q, BiTree t) {
-    if ((q->rear + 1) % MAXSIZE == q->front) return 0; // 队满
-    q->data[q->rear] = t;
-    q->rear = (q->rear + 1) % MAXSIZE;
+    if (q->data == NULL) return 0;
+    if (q->rear - q->front == q->mask + 1) { // 队满：按原顺序搬到两倍大的新数组
+        size_t cap = (q->mask + 1) * 2, i, len = q->rear - q->front;
+        BiTree *nd = (BiTree *)malloc(cap * sizeof(BiTree));
+        if (nd == NULL) return 0;
+        for (i = 0; i < len; i++) nd[i] = q->data[(q->front + i) & q->mask];
+        free(q->data);
+        q->data = nd;
+        q->front = 0;
+        q->rear = len;
+        q->mask = cap - 1;
+    }
+    q->data[q->rear++ & q->mask] = t;
     return 1;
 }
 
 // 4.4 出队
 int DeQueue(SqQueue *q, BiTree *t) {
     if (q->front == q->rear) return 0; // 队空
-    *t = q->data[q->front];
-    q->front = (q->front + 1) % MAXSIZE;
+    *t = q->data[q->front++ & q->mask];
     return 1;
 }
 
 //层序遍历核心函数
 void LevelOrder(BiTree T){
     SqQueue q;
-    InitQueue(&q);
     BiTree p;
+    if(!T) return;
+    InitQueue(&q);
     EnQueue(&q,T);  //根节点入队
     while(q.front!=q.rear){
         DeQueue(&q,&p);
@@ -95,6 +134,7 @@ void LevelOrder(BiTree T){
         if(p->lchild)EnQueue(&q,p->lchild);
         if(p->rchild)EnQueue(&q,p->rchild);
     }
+    DestroyQueue(&q);
 }
 
 //求二叉树高度
@@ -127,8 +167,8 @@ BiTree FindNode(BiTree T, int val) {
 // ====================== 8. 拓展：判断是否为完全二叉树（期末选考） ======================
 int IsCompleteBiTree(BiTree T) {
     SqQueue q;
-    InitQueue(&q);
     if (!T) return 1; // 空树是完全二叉树
+    InitQueue(&q);
     EnQueue(&q, T);
     BiTree p;
     while (DeQueue(&q, &p)) {
@@ -137,50 +177,2626 @@ int IsCompleteBiTree(BiTree T) {
             EnQueue(&q, p->rchild);
         } else { // 遇到空节点后，后续必须全是空节点
             while (DeQueue(&q, &p)) {
-                if (p) return 0; // 非空，不是完全二叉树
+                if (p) { // 非空，不是完全二叉树
+                    DestroyQueue(&q);
+                    return 0;
+                }
             }
         }
     }
+    DestroyQueue(&q);
     return 1;
 }
 
+// ====================== 9. 二进制序列化：先序位图 + 紧凑值数组 ======================
+// 文件格式（小端）：
+//   头部16字节：魔数"BTR1"、4字节保留、8字节节点数count
+//   位图：2*count位，按64位字存放，第i个（先序）节点占第2i位（有左孩子）和第2i+1位（有右孩子）
+//   值数组：count个int32，先序排列
+// 头部和位图都按8字节对齐，mmap之后可以直接把位图和值数组当数组用。
+#define BTR_MAGIC "BTR1"
+#define BTR_HEADER 16
 
-//主函数 测试
-int main() {
-    INIT_UTF8_CONSOLE();
-    BiTree T, find_res;
-    int val, height, leaf_cnt;
+typedef struct {
+    char magic[4];
+    uint32_t reserved;
+    uint64_t count;
+} BtrHeader;
 
-    // 1. 创建二叉树
-    printf("输入二叉树节点（-1表示空节点，先序顺序）：\n");
-    CreateBiTree(&T); // 测试用例：1 2 4 -1 -1 5 -1 -1 3 -1 6 -1 -1
+// 位图占用的64位字数
+static uint64_t BtrBitmapWords(uint64_t count) {
+    return (2 * count + 63) / 64;
+}
 
-    // 2. 三种递归遍历
-    printf("先序遍历："); PreOrder(T); printf("\n");
-    printf("中序遍历："); InOrder(T); printf("\n");
-    printf("后序遍历："); PostOrder(T); printf("\n");
+// 显式栈：非递归遍历/构建时存放待处理的指针（按需倍增）
+typedef struct {
+    void **item;
+    size_t top, cap;
+} PtrStack;
 
-    // 3. 层序遍历
-    printf("层序遍历："); LevelOrder(T); printf("\n");
+static void PtrPush(PtrStack *s, void *p) {
+    if (s->top == s->cap) {
+        s->cap = s->cap ? s->cap * 2 : 256;
+        s->item = (void **)realloc(s->item, s->cap * sizeof(void *));
+        if (s->item == NULL) {
+            printf("错误！内存分配失败\n");
+            exit(1);
+        }
+    }
+    s->item[s->top++] = p;
+}
 
-    // 4. 求高度
-    height = GetTreeHeight(T);
-    printf("二叉树高度：%d\n", height); // 测试用例输出：3
+static void *PtrPop(PtrStack *s) {
+    return s->top > 0 ? s->item[--s->top] : NULL;
+}
 
-    // 5. 统计叶子节点
-    leaf_cnt = CountLeaf(T);
-    printf("叶子节点个数：%d\n", leaf_cnt); // 测试用例输出：3（4、5、6）
+// 统计节点数（非递归）
+uint64_t CountNodes(BiTree T) {
+    PtrStack st = {NULL, 0, 0};
+    uint64_t cnt = 0;
+    if (T) PtrPush(&st, T);
+    while (st.top > 0) {
+        BiTree p = (BiTree)PtrPop(&st);
+        cnt++;
+        if (p->rchild) PtrPush(&st, p->rchild);
+        if (p->lchild) PtrPush(&st, p->lchild);
+    }
+    free(st.item);
+    return cnt;
+}
 
-    // 6. 查找节点
-    printf("输入要查找的节点值：");
-    scanf("%d", &val);
-    find_res = FindNode(T, val);
-    if (find_res) printf("找到节点：%d\n", find_res->data);
-    else printf("未找到该节点\n");
+// 把任意BiTree写成二进制文件，成功返回1
+int SaveBiTree(BiTree T, const char *path) {
+    PtrStack st = {NULL, 0, 0};
+    BtrHeader h;
+    uint64_t *bits, words, i = 0;
+    int32_t buf[4096];
+    int k = 0, ok;
+    FILE *fp;
 
-    // 7. 判断完全二叉树
-    if (IsCompleteBiTree(T)) printf("是完全二叉树\n");
-    else printf("不是完全二叉树\n"); // 测试用例输出：是
+    memcpy(h.magic, BTR_MAGIC, 4);
+    h.reserved = 0;
+    h.count = CountNodes(T);
+    words = BtrBitmapWords(h.count);
+    bits = (uint64_t *)calloc(words ? words : 1, sizeof(uint64_t));
+    fp = fopen(path, "wb");
+    if (bits == NULL || fp == NULL) {
+        free(bits);
+        if (fp) fclose(fp);
+        return 0;
+    }
+
+    // 第一遍：先序生成孩子位图
+    if (T) PtrPush(&st, T);
+    while (st.top > 0) {
+        BiTree p = (BiTree)PtrPop(&st);
+        if (p->lchild) bits[(2 * i) >> 6] |= 1ULL << ((2 * i) & 63);
+        if (p->rchild) bits[(2 * i + 1) >> 6] |= 1ULL << ((2 * i + 1) & 63);
+        i++;
+        if (p->rchild) PtrPush(&st, p->rchild);
+        if (p->lchild) PtrPush(&st, p->lchild);
+    }
+    ok = fwrite(&h, BTR_HEADER, 1, fp) == 1 && fwrite(bits, sizeof(uint64_t), words, fp) == words;
+
+    // 第二遍：先序写值，攒满一块写一次
+    if (T) PtrPush(&st, T);
+    while (ok && st.top > 0) {
+        BiTree p = (BiTree)PtrPop(&st);
+        buf[k++] = p->data;
+        if (k == 4096) {
+            ok = fwrite(buf, sizeof(int32_t), k, fp) == (size_t)k;
+            k = 0;
+        }
+        if (p->rchild) PtrPush(&st, p->rchild);
+        if (p->lchild) PtrPush(&st, p->lchild);
+    }
+    if (ok && k > 0) ok = fwrite(buf, sizeof(int32_t), k, fp) == (size_t)k;
+    ok = (fclose(fp) == 0) && ok;
+    free(st.item);
+    free(bits);
+    return ok;
+}
+
+// 只读映射整个文件（Windows用文件映射，其他平台用mmap），失败返回NULL
+typedef struct {
+    const unsigned char *base;
+    size_t size;
+#ifdef _WIN32
+    HANDLE file, mapping;
+#endif
+} FileMap;
+
+static const unsigned char *MapFile(FileMap *fm, const char *path) {
+#ifdef _WIN32
+    LARGE_INTEGER sz;
+    fm->base = NULL;
+    fm->file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                           FILE_ATTRIBUTE_NORMAL, NULL);
+    if (fm->file == INVALID_HANDLE_VALUE) return NULL;
+    if (!GetFileSizeEx(fm->file, &sz) || sz.QuadPart == 0) {
+        CloseHandle(fm->file);
+        return NULL;
+    }
+    fm->size = (size_t)sz.QuadPart;
+    fm->mapping = CreateFileMappingA(fm->file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (fm->mapping == NULL) {
+        CloseHandle(fm->file);
+        return NULL;
+    }
+    fm->base = (const unsigned char *)MapViewOfFile(fm->mapping, FILE_MAP_READ, 0, 0, 0);
+    if (fm->base == NULL) {
+        CloseHandle(fm->mapping);
+        CloseHandle(fm->file);
+    }
+    return fm->base;
+#else
+    struct stat st;
+    void *p;
+    int fd = open(path, O_RDONLY);
+    fm->base = NULL;
+    if (fd < 0) return NULL;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        close(fd);
+        return NULL;
+    }
+    fm->size = (size_t)st.st_size;
+    p = mmap(NULL, fm->size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);  // 映射建立后文件描述符可以关闭
+    if (p == MAP_FAILED) return NULL;
+    fm->base = (const unsigned char *)p;
+    return fm->base;
+#endif
+}
+
+static void UnmapFile(FileMap *fm) {
+    if (fm->base == NULL) return;
+#ifdef _WIN32
+    UnmapViewOfFile(fm->base);
+    CloseHandle(fm->mapping);
+    CloseHandle(fm->file);
+#else
+    munmap((void *)fm->base, fm->size);
+#endif
+    fm->base = NULL;
+}
+
+// 校验头部并返回节点数，格式不对返回-1
+static int64_t CheckBtr(const unsigned char *base, size_t size) {
+    BtrHeader h;
+    if (size < BTR_HEADER) return -1;
+    memcpy(&h, base, BTR_HEADER);
+    if (memcmp(h.magic, BTR_MAGIC, 4) != 0) return -1;
+    if (size < BTR_HEADER + BtrBitmapWords(h.count) * 8 + h.count * 4) return -1;
+    return (int64_t)h.count;
+}
+
+// 第i个节点是否有左/右孩子
+#define BTR_HAS_LEFT(bits, i)  (((bits)[(2 * (i)) >> 6] >> ((2 * (i)) & 63)) & 1)
+#define BTR_HAS_RIGHT(bits, i) (((bits)[(2 * (i) + 1) >> 6] >> ((2 * (i) + 1) & 63)) & 1)
+
+// 加载方式一：一次性分配节点池，单遍链接成普通BiTree（可直接使用前面所有算法）
+// 成功返回1，树放在*T（0个节点的文件得到空树）；*pool返回节点池首地址，用完free(*pool)即可释放整棵树
+int LoadBiTree(const char *path, BiTree *T, BiTNode **pool) {
+    FileMap fm;
+    PtrStack st = {NULL, 0, 0};
+    const uint64_t *bits;
+    const int32_t *vals;
+    BiTree *slot;
+    int64_t cnt, i;
+
+    *T = NULL;
+    *pool = NULL;
+    if (MapFile(&fm, path) == NULL) return 0;
+    cnt = CheckBtr(fm.base, fm.size);
+    if (cnt <= 0) {
+        UnmapFile(&fm);
+        return cnt == 0;
+    }
+    bits = (const uint64_t *)(fm.base + BTR_HEADER);
+    vals = (const int32_t *)(bits + BtrBitmapWords((uint64_t)cnt));
+    *pool = (BiTNode *)malloc((size_t)cnt * sizeof(BiTNode));
+    if (*pool == NULL) {
+        UnmapFile(&fm);
+        return 0;
+    }
+
+    // slot指向下一个节点应该挂的位置；有右孩子的节点把右指针位置压栈，左子树结束后弹出
+    slot = T;
+    for (i = 0; i < cnt && slot != NULL; i++) {
+        BiTNode *p = &(*pool)[i];
+        p->data = vals[i];
+        p->lchild = p->rchild = NULL;
+        *slot = p;
+        if (BTR_HAS_RIGHT(bits, i)) PtrPush(&st, &p->rchild);
+        slot = BTR_HAS_LEFT(bits, i) ? &p->lchild : (BiTree *)PtrPop(&st);
+    }
+    free(st.item);
+    UnmapFile(&fm);
+    return 1;
+}
+
+// 加载方式二：零拷贝视图。位图和值数组直接用映射内存，只额外建一个右孩子下标数组
+// 节点用先序下标表示：根为0，左孩子为i+1（若存在），右孩子为right[i]（0表示没有）
+typedef struct {
+    FileMap fm;
+    int64_t count;
+    const uint64_t *bits;   // 指向映射内存
+    const int32_t *vals;    // 指向映射内存
+    uint32_t *right;        // 右孩子下标（单遍计算）
+} BiTreeView;
+
+int MapBiTree(BiTreeView *v, const char *path) {
+    PtrStack st = {NULL, 0, 0};
+    int64_t i;
+
+    v->right = NULL;
+    if (MapFile(&v->fm, path) == NULL) return 0;
+    v->count = CheckBtr(v->fm.base, v->fm.size);
+    if (v->count < 0 || v->count > UINT32_MAX) {
+        UnmapFile(&v->fm);
+        return 0;
+    }
+    v->bits = (const uint64_t *)(v->fm.base + BTR_HEADER);
+    v->vals = (const int32_t *)(v->bits + BtrBitmapWords((uint64_t)v->count));
+    if (v->count == 0) return 1;    // 空树：没有节点可导航，right保持NULL
+    v->right = (uint32_t *)calloc((size_t)v->count, sizeof(uint32_t));
+    if (v->right == NULL) {
+        UnmapFile(&v->fm);
+        return 0;
+    }
+    // 与LoadBiTree相同的单遍扫描：没有左孩子时，下一个节点就是最近一个待定的右孩子
+    for (i = 0; i + 1 < v->count; i++) {
+        if (BTR_HAS_RIGHT(v->bits, i)) PtrPush(&st, &v->right[i]);
+        if (!BTR_HAS_LEFT(v->bits, i)) {
+            uint32_t *r = (uint32_t *)PtrPop(&st);
+            if (r) *r = (uint32_t)(i + 1);
+        }
+    }
+    free(st.item);
+    return 1;
+}
+
+void UnmapBiTree(BiTreeView *v) {
+    free(v->right);
+    v->right = NULL;
+    UnmapFile(&v->fm);
+}
+
+// 视图上的导航：不存在返回-1
+static int64_t ViewLeft(const BiTreeView *v, int64_t i) {
+    return BTR_HAS_LEFT(v->bits, i) ? i + 1 : -1;
+}
+
+static int64_t ViewRight(const BiTreeView *v, int64_t i) {
+    return BTR_HAS_RIGHT(v->bits, i) ? (int64_t)v->right[i] : -1;
+}
+
+// ====================== 10. 按层批量的层序遍历（frontier）与并行BFS ======================
+// 不用队列，而是把整层节点放在一个数组里（frontier），一次处理一整层生成下一层数组。
+// 每层内部各节点互不依赖，层足够宽时可以切成若干段交给多个线程同时处理。
+// 这些段作为任务交给第11节的工作窃取运行时：线程只在遇到第一个宽层时创建一次，各层复用。
+
+#define FRONTIER_CUTOFF 65536  // 一层节点数超过该值才分给多个线程
+
+// 一层数组的缓冲区（两个交替使用）
+typedef struct {
+    BiTree *node;
+    size_t len, cap;
+} Frontier;
+
+static int FrontierReserve(Frontier *f, size_t cap) {
+    if (cap <= f->cap) return 1;
+    BiTree *p = (BiTree *)realloc(f->node, cap * sizeof(BiTree));
+    if (p == NULL) return 0;
+    f->node = p;
+    f->cap = cap;
+    return 1;
+}
+
+// 一个任务负责当前层[begin,end)这一段
+typedef struct {
+    BiTree *cur;
+    size_t begin, end;
+    int *out;          // 本层值的输出位置（按下标对应）
+    BiTree *next;      // 第二阶段：孩子写入的位置
+    size_t children;   // 第一阶段：本段孩子数
+} FrontierTask;
+
+// 第一阶段：输出本段的值，并统计孩子数
+static void FrontierCount(FrontierTask *t) {
+    size_t i, c = 0;
+    for (i = t->begin; i < t->end; i++) {
+        BiTree p = t->cur[i];
+        t->out[i] = p->data;
+        c += (p->lchild != NULL) + (p->rchild != NULL);
+    }
+    t->children = c;
+}
+
+// 第二阶段：按前缀和算好的位置写出孩子，保证下一层仍是从左到右的顺序
+static void FrontierExpand(FrontierTask *t) {
+    BiTree *w = t->next;
+    size_t i;
+    for (i = t->begin; i < t->end; i++) {
+        BiTree p = t->cur[i];
+        if (p->lchild) *w++ = p->lchild;
+        if (p->rchild) *w++ = p->rchild;
+    }
+}
+
+// 见第11节：在运行时上并行执行used段的某一阶段，返回时各段都已完成
+typedef struct WsPool WsPool;
+WsPool *WsCreate(int threads);
+void WsDestroy(WsPool *p);
+static void FrontierParallel(WsPool *p, FrontierTask *task, int used, void (*phase)(FrontierTask *));
+
+// 按层批量遍历，把值按层序写入out（容量至少为节点数），返回节点总数
+// threads>1时宽的层并行处理；level_width不为NULL时记录每层宽度（最多max_levels层）
+int64_t LevelOrderFrontier(BiTree T, int *out, int threads, int64_t *level_width, int max_levels) {
+    Frontier a = {NULL, 0, 0}, b = {NULL, 0, 0}, *cur = &a, *nxt = &b, *tmp;
+    FrontierTask task[64];
+    WsPool *pool = NULL;
+    int64_t total = 0;
+    int level = 0, k, used;
+    size_t chunk, off;
+
+    if (!T) return 0;
+    if (threads > 64) threads = 64;
+    if (!FrontierReserve(cur, 1)) return -1;
+    cur->node[0] = T;
+    cur->len = 1;
+    while (cur->len > 0) {
+        if (level_width && level < max_levels) level_width[level] = (int64_t)cur->len;
+        level++;
+        // 切段：窄层只用一段，在当前线程里直接做
+        used = (threads > 1 && cur->len >= FRONTIER_CUTOFF) ? threads : 1;
+        if (used > 1 && pool == NULL) pool = WsCreate(threads);
+        if (pool == NULL) used = 1;
+        chunk = (cur->len + used - 1) / used;
+        for (k = 0; k < used; k++) {
+            task[k].cur = cur->node;
+            task[k].begin = k * chunk < cur->len ? k * chunk : cur->len;
+            task[k].end = (k + 1) * chunk < cur->len ? (k + 1) * chunk : cur->len;
+            task[k].out = out + total;
+        }
+        if (used > 1) FrontierParallel(pool, task, used, FrontierCount);
+        else FrontierCount(&task[0]);
+
+        // 前缀和确定每段孩子在下一层中的起始位置
+        for (k = 0, off = 0; k < used; k++) off += task[k].children;
+        if (!FrontierReserve(nxt, off)) {
+            if (pool) WsDestroy(pool);
+            free(a.node);
+            free(b.node);
+            return -1;
+        }
+        for (k = 0, off = 0; k < used; k++) {
+            task[k].next = nxt->node + off;
+            off += task[k].children;
+        }
+        if (used > 1) FrontierParallel(pool, task, used, FrontierExpand);
+        else FrontierExpand(&task[0]);
+
+        total += (int64_t)cur->len;
+        nxt->len = off;
+        tmp = cur;
+        cur = nxt;
+        nxt = tmp;
+    }
+    if (pool) WsDestroy(pool);
+    free(a.node);
+    free(b.node);
+    return total;
+}
+
+// ====================== 11. 工作窃取（work-stealing）fork-join运行时 ======================
+// 每个工作线程有一个Chase-Lev双端队列：自己在底部压入/弹出任务（无锁、几乎无竞争），
+// 空闲线程从别人的顶部窃取。WsSpawn把子任务压入本线程队列，WsSync等待它完成：
+// 任务没被偷走就直接在本线程执行，被偷走了就一边窃取别的任务一边等。
+// 递归算法在较深的层次改用串行版本（WS_SEQ_DEPTH），避免任务太碎。
+
+#define WS_MAX_THREADS 64
+#define WS_SEQ_DEPTH 14     // 递归深度达到该值后改为串行计算
+
+typedef struct WsTask {
+    void (*fn)(struct WsTask *);   // 任务函数（参数是任务自身，具体任务把WsTask放在结构体开头）
+    atomic_int done;               // 执行完毕置1
+} WsTask;
+
+// 队列的环形数组，容量为2的幂；扩容后旧数组要等运行时销毁时再释放（窃取者可能还在读）
+typedef struct WsArray {
+    int64_t size;
+    struct WsArray *prev;          // 被替换下来的旧数组链
+    _Atomic(WsTask *) buf[];
+} WsArray;
+
+typedef struct {
+    atomic_llong top, bottom;
+    _Atomic(WsArray *) array;
+} WsDeque;
+
+struct WsPool;
+typedef struct {
+    WsDeque dq;
+    struct WsPool *pool;
+    int id;
+    unsigned long long seed;       // 选择窃取对象的随机数
+    pthread_t tid;
+} WsWorker;
+
+typedef struct WsPool {
+    int threads;
+    WsWorker worker[WS_MAX_THREADS];
+    atomic_int running;            // 有WsRun正在执行时为1，空闲线程才去窃取
+    atomic_int stop;
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+} WsPool;
+
+static _Thread_local WsWorker *ws_self = NULL;   // 当前线程对应的工作者
+
+static WsArray *WsNewArray(int64_t size, WsArray *prev) {
+    WsArray *a = (WsArray *)malloc(sizeof(WsArray) + (size_t)size * sizeof(_Atomic(WsTask *)));
+    if (a == NULL) {
+        printf("错误！内存分配失败\n");
+        exit(1);
+    }
+    a->size = size;
+    a->prev = prev;
+    return a;
+}
+
+static void WsYield(void) {
+#ifdef _WIN32
+    SwitchToThread();
+#else
+    sched_yield();
+#endif
+}
+
+// 底部压入（只有队列主人调用）
+static void WsPush(WsDeque *d, WsTask *x) {
+    int64_t b = atomic_load_explicit(&d->bottom, memory_order_relaxed);
+    int64_t t = atomic_load_explicit(&d->top, memory_order_acquire);
+    WsArray *a = atomic_load_explicit(&d->array, memory_order_relaxed);
+    int64_t i;
+
+    if (b - t > a->size - 1) {                 // 满了：容量翻倍并搬运[t,b)
+        WsArray *na = WsNewArray(a->size * 2, a);
+        for (i = t; i < b; i++) {
+            atomic_store_explicit(&na->buf[i & (na->size - 1)],
+                                  atomic_load_explicit(&a->buf[i & (a->size - 1)], memory_order_relaxed),
+                                  memory_order_relaxed);
+        }
+        atomic_store_explicit(&d->array, na, memory_order_release);
+        a = na;
+    }
+    // 槽位用release写、窃取者用acquire读（x86上没有额外开销），保证偷到的任务内容可见
+    atomic_store_explicit(&a->buf[b & (a->size - 1)], x, memory_order_release);
+    atomic_thread_fence(memory_order_release);
+    atomic_store_explicit(&d->bottom, b + 1, memory_order_relaxed);
+}
+
+// 底部弹出（只有队列主人调用），空返回NULL
+static WsTask *WsTake(WsDeque *d) {
+    int64_t b = atomic_load_explicit(&d->bottom, memory_order_relaxed) - 1;
+    WsArray *a = atomic_load_explicit(&d->array, memory_order_relaxed);
+    int64_t t;
+    WsTask *x = NULL;
+
+    atomic_store_explicit(&d->bottom, b, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    t = atomic_load_explicit(&d->top, memory_order_relaxed);
+    if (t <= b) {
+        x = atomic_load_explicit(&a->buf[b & (a->size - 1)], memory_order_relaxed);
+        if (t == b) {                           // 最后一个元素：与窃取者抢
+            if (!atomic_compare_exchange_strong_explicit(&d->top, &t, t + 1,
+                                                         memory_order_seq_cst, memory_order_relaxed)) {
+                x = NULL;
+            }
+            atomic_store_explicit(&d->bottom, b + 1, memory_order_relaxed);
+        }
+    } else {
+        atomic_store_explicit(&d->bottom, b + 1, memory_order_relaxed);
+    }
+    return x;
+}
+
+// 顶部窃取（其他线程调用），空或竞争失败返回NULL
+static WsTask *WsSteal(WsDeque *d) {
+    int64_t t = atomic_load_explicit(&d->top, memory_order_acquire);
+    int64_t b;
+    WsTask *x;
+    WsArray *a;
+
+    atomic_thread_fence(memory_order_seq_cst);
+    b = atomic_load_explicit(&d->bottom, memory_order_acquire);
+    if (t >= b) return NULL;
+    a = atomic_load_explicit(&d->array, memory_order_acquire);
+    x = atomic_load_explicit(&a->buf[t & (a->size - 1)], memory_order_acquire);
+    if (!atomic_compare_exchange_strong_explicit(&d->top, &t, t + 1,
+                                                 memory_order_seq_cst, memory_order_relaxed)) {
+        return NULL;
+    }
+    return x;
+}
+
+static void WsExecute(WsTask *x) {
+    x->fn(x);
+    atomic_store_explicit(&x->done, 1, memory_order_release);
+}
+
+// 随机挑一个别的工作者窃取一次
+static WsTask *WsTrySteal(WsWorker *w) {
+    WsPool *p = w->pool;
+    int v;
+    if (p->threads < 2) return NULL;
+    w->seed ^= w->seed << 13;
+    w->seed ^= w->seed >> 7;
+    w->seed ^= w->seed << 17;
+    v = (int)(w->seed % (unsigned long long)(p->threads - 1));
+    if (v >= w->id) v++;                     // 跳过自己
+    return WsSteal(&p->worker[v].dq);
+}
+
+// 工作线程主循环：有任务时不断窃取，空闲时睡眠等待下一次WsRun
+static void *WsWorkerMain(void *arg) {
+    WsWorker *w = (WsWorker *)arg;
+    WsPool *p = w->pool;
+    WsTask *x;
+    int fails = 0;
+
+    ws_self = w;
+    while (!atomic_load(&p->stop)) {
+        if (!atomic_load(&p->running)) {
+            pthread_mutex_lock(&p->lock);
+            while (!atomic_load(&p->running) && !atomic_load(&p->stop)) {
+                pthread_cond_wait(&p->wake, &p->lock);
+            }
+            pthread_mutex_unlock(&p->lock);
+            continue;
+        }
+        x = WsTake(&w->dq);
+        if (x == NULL) x = WsTrySteal(w);
+        if (x != NULL) {
+            WsExecute(x);
+            fails = 0;
+        } else if (++fails > 64) {
+            WsYield();
+            fails = 0;
+        }
+    }
+    return NULL;
+}
+
+// 创建运行时：threads个工作者（调用WsRun的线程算作0号）
+WsPool *WsCreate(int threads) {
+    WsPool *p = (WsPool *)calloc(1, sizeof(WsPool));
+    int i, k;
+
+    if (p == NULL) return NULL;
+    if (threads < 1) threads = 1;
+    if (threads > WS_MAX_THREADS) threads = WS_MAX_THREADS;
+    p->threads = threads;
+    atomic_init(&p->running, 0);
+    atomic_init(&p->stop, 0);
+    pthread_mutex_init(&p->lock, NULL);
+    pthread_cond_init(&p->wake, NULL);
+    for (i = 0; i < threads; i++) {
+        WsWorker *w = &p->worker[i];
+        atomic_init(&w->dq.top, 0);
+        atomic_init(&w->dq.bottom, 0);
+        atomic_init(&w->dq.array, WsNewArray(256, NULL));
+        w->pool = p;
+        w->id = i;
+        w->seed = 0x9E3779B97F4A7C15ULL * (i + 1);
+    }
+    for (i = 1; i < threads; i++) {
+        // 创建失败就只用已经启动的线程，WsDestroy也只join这些
+        if (pthread_create(&p->worker[i].tid, NULL, WsWorkerMain, &p->worker[i]) != 0) {
+            for (k = i; k < threads; k++) free(atomic_load(&p->worker[k].dq.array));
+            p->threads = i;
+            break;
+        }
+    }
+    return p;
+}
+
+void WsDestroy(WsPool *p) {
+    int i;
+    WsArray *a, *prev;
+
+    pthread_mutex_lock(&p->lock);
+    atomic_store(&p->stop, 1);
+    pthread_cond_broadcast(&p->wake);
+    pthread_mutex_unlock(&p->lock);
+    for (i = 1; i < p->threads; i++) pthread_join(p->worker[i].tid, NULL);
+    for (i = 0; i < p->threads; i++) {
+        for (a = atomic_load(&p->worker[i].dq.array); a != NULL; a = prev) {
+            prev = a->prev;
+            free(a);
+        }
+    }
+    pthread_mutex_destroy(&p->lock);
+    pthread_cond_destroy(&p->wake);
+    free(p);
+}
+
+// 派生子任务：压入当前工作者的队列，可能被其他线程偷走执行
+void WsSpawn(WsTask *x) {
+    atomic_init(&x->done, 0);
+    if (ws_self == NULL) {         // 不在运行时线程里：直接执行
+        WsExecute(x);
+        return;
+    }
+    WsPush(&ws_self->dq, x);
+}
+
+// 等待子任务完成：优先从自己队列底部取回执行，被偷走时帮忙执行别的任务
+void WsSync(WsTask *x) {
+    WsTask *y;
+    while (!atomic_load_explicit(&x->done, memory_order_acquire)) {
+        y = WsTake(&ws_self->dq);
+        if (y == NULL) y = WsTrySteal(ws_self);
+        if (y != NULL) WsExecute(y);
+        else WsYield();
+    }
+}
+
+// 在运行时中执行根任务并等待结束（由普通线程调用，期间它充当0号工作者）
+void WsRun(WsPool *p, WsTask *root) {
+    WsWorker *saved = ws_self;
+
+    ws_self = &p->worker[0];
+    pthread_mutex_lock(&p->lock);
+    atomic_store(&p->running, 1);
+    pthread_cond_broadcast(&p->wake);
+    pthread_mutex_unlock(&p->lock);
+
+    atomic_init(&root->done, 0);
+    WsExecute(root);
+
+    atomic_store(&p->running, 0);
+    ws_self = saved;
+}
+
+// ---------- 基于运行时的并行树算法 ----------
+typedef enum { PAR_HEIGHT, PAR_LEAF, PAR_FIND } ParOp;
+
+typedef struct {
+    WsTask task;       // 必须是第一个成员
+    ParOp op;
+    BiTree T;
+    int depth;
+    int val;           // PAR_FIND：要找的值
+    int64_t result;    // 高度或叶子数
+    BiTree found;      // PAR_FIND的结果
+} TreeTask;
+
+static void TreeTaskFn(WsTask *t);
+
+// 对T做op：左子树派生为任务，右子树在本线程递归，然后合并
+static void ParTree(TreeTask *me) {
+    BiTree T = me->T;
+    TreeTask left, right;
+
+    if (!T) {
+        me->result = 0;
+        me->found = NULL;
+        return;
+    }
+    if (me->depth >= WS_SEQ_DEPTH) {          // 串行阈值：直接调用原来的递归版本
+        if (me->op == PAR_HEIGHT) me->result = GetTreeHeight(T);
+        else if (me->op == PAR_LEAF) me->result = CountLeaf(T);
+        else me->found = FindNode(T, me->val);
+        return;
+    }
+    if (me->op == PAR_LEAF && !T->lchild && !T->rchild) {
+        me->result = 1;
+        return;
+    }
+    if (me->op == PAR_FIND && T->data == me->val) {
+        me->found = T;                        // 先序第一个匹配就是根
+        return;
+    }
+    left = *me;
+    left.task.fn = TreeTaskFn;
+    left.T = T->lchild;
+    left.depth = me->depth + 1;
+    right = left;
+    right.T = T->rchild;
+
+    WsSpawn(&left.task);
+    ParTree(&right);
+    WsSync(&left.task);
+
+    if (me->op == PAR_HEIGHT) me->result = (left.result > right.result ? left.result : right.result) + 1;
+    else if (me->op == PAR_LEAF) me->result = left.result + right.result;
+    else me->found = left.found ? left.found : right.found;   // 与FindNode一样左子树优先
+}
+
+static void TreeTaskFn(WsTask *t) {
+    ParTree((TreeTask *)t);
+}
+
+static TreeTask RunTreeTask(WsPool *p, ParOp op, BiTree T, int val) {
+    TreeTask t;
+    t.task.fn = TreeTaskFn;
+    t.op = op;
+    t.T = T;
+    t.depth = 0;
+    t.val = val;
+    t.result = 0;
+    t.found = NULL;
+    WsRun(p, &t.task);
+    return t;
+}
+
+// 并行求高度、叶子数、查找节点（结果与递归版本相同）
+int ParGetTreeHeight(WsPool *p, BiTree T) {
+    return (int)RunTreeTask(p, PAR_HEIGHT, T, 0).result;
+}
+
+int64_t ParCountLeaf(WsPool *p, BiTree T) {
+    return RunTreeTask(p, PAR_LEAF, T, 0).result;
+}
+
+BiTree ParFindNode(WsPool *p, BiTree T, int val) {
+    return RunTreeTask(p, PAR_FIND, T, val).found;
+}
+
+// ---------- 按层遍历（第10节）的并行阶段 ----------
+typedef struct {
+    WsTask task;                    // 必须是第一个成员
+    void (*phase)(FrontierTask *);
+    FrontierTask *part;
+    int used;                       // 根任务：共几段；单段任务为0
+} FrontierJob;
+
+// 根任务派生1..used-1段，0号段在本线程做，再按相反顺序等待（先取回最后压入的）
+static void FrontierJobFn(WsTask *x) {
+    FrontierJob *j = (FrontierJob *)x, sub[64];
+    int k;
+    if (j->used == 0) {
+        j->phase(j->part);
+        return;
+    }
+    for (k = 1; k < j->used; k++) {
+        sub[k].task.fn = FrontierJobFn;
+        sub[k].phase = j->phase;
+        sub[k].part = &j->part[k];
+        sub[k].used = 0;
+        WsSpawn(&sub[k].task);
+    }
+    j->phase(&j->part[0]);
+    for (k = j->used - 1; k >= 1; k--) WsSync(&sub[k].task);
+}
+
+static void FrontierParallel(WsPool *p, FrontierTask *task, int used, void (*phase)(FrontierTask *)) {
+    FrontierJob root;
+    root.task.fn = FrontierJobFn;
+    root.phase = phase;
+    root.part = task;
+    root.used = used;
+    WsRun(p, &root.task);
+}
+
+// ====================== 12. 增量维护的子树聚合信息（高度/节点数/叶子数/完全性） ======================
+// 增强节点：每个节点保存以它为根的子树的聚合信息，并带父指针。
+// 插入/删除后只沿修改点到根的路径重新计算（O(depth)），之后高度、叶子数、是否完全二叉树在根上O(1)得到。
+// 完全性用两个标志合并（空树：高度0，两者都为1）：
+//   perfect(T)  = perfect(L) && perfect(R) && h(L) == h(R)                       （满二叉树）
+//   complete(T) = (perfect(L) && complete(R) && h(L) == h(R))
+//              || (complete(L) && perfect(R) && h(L) == h(R) + 1)                （完全二叉树）
+typedef struct AugTNode {
+    int data;
+    int height;                 // 子树高度
+    int64_t size;               // 子树节点数
+    int64_t leaves;             // 子树叶子数
+    unsigned char perfect;      // 子树是否为满二叉树
+    unsigned char complete;     // 子树是否为完全二叉树
+    struct AugTNode *lchild;
+    struct AugTNode *rchild;
+    struct AugTNode *parent;
+} AugTNode, *AugTree;
+
+// 由左右孩子的聚合信息重新计算p的聚合信息
+static void AugPull(AugTNode *p) {
+    AugTNode *l = p->lchild, *r = p->rchild;
+    int lh = l ? l->height : 0, rh = r ? r->height : 0;
+    int lp = l ? l->perfect : 1, rp = r ? r->perfect : 1;
+    int lc = l ? l->complete : 1, rc = r ? r->complete : 1;
+
+    p->height = (lh > rh ? lh : rh) + 1;
+    p->size = 1 + (l ? l->size : 0) + (r ? r->size : 0);
+    p->leaves = (!l && !r) ? 1 : (l ? l->leaves : 0) + (r ? r->leaves : 0);
+    p->perfect = lp && rp && lh == rh;
+    p->complete = (lp && rc && lh == rh) || (lc && rp && lh == rh + 1);
+}
+
+// 从p开始沿父指针一直更新到根
+static void AugFixUp(AugTNode *p) {
+    for (; p; p = p->parent) AugPull(p);
+}
+
+static AugTNode *NewAugNode(int val, AugTNode *parent) {
+    AugTNode *p = (AugTNode *)malloc(sizeof(AugTNode));
+    if (p == NULL) {
+        printf("错误！内存分配失败\n");
+        exit(1);
+    }
+    p->data = val;
+    p->lchild = p->rchild = NULL;
+    p->parent = parent;
+    AugPull(p);
+    return p;
+}
+
+// 由普通二叉树复制出增强树（非递归）：先序建立节点，再按先序逆序汇总（孩子总在父亲之后）
+AugTree ToAugTree(BiTree T) {
+    PtrStack st = {NULL, 0, 0};
+    AugTNode **order;
+    AugTree root;
+    uint64_t cnt = CountNodes(T), k = 0;
+
+    if (!T) return NULL;
+    order = (AugTNode **)malloc(cnt * sizeof(AugTNode *));
+    if (order == NULL) {
+        printf("错误！内存分配失败\n");
+        exit(1);
+    }
+    root = NewAugNode(T->data, NULL);
+    PtrPush(&st, T);
+    PtrPush(&st, root);
+    while (st.top > 0) {
+        AugTNode *q = (AugTNode *)PtrPop(&st);   // 成对出栈：增强节点、对应的原节点
+        BiTree p = (BiTree)PtrPop(&st);
+        order[k++] = q;
+        if (p->rchild) {
+            q->rchild = NewAugNode(p->rchild->data, q);
+            PtrPush(&st, p->rchild);
+            PtrPush(&st, q->rchild);
+        }
+        if (p->lchild) {
+            q->lchild = NewAugNode(p->lchild->data, q);
+            PtrPush(&st, p->lchild);
+            PtrPush(&st, q->lchild);
+        }
+    }
+    while (k > 0) AugPull(order[--k]);
+    free(order);
+    free(st.item);
+    return root;
+}
+
+// 在p的左（left非0）或右空位挂一个新叶子；p为NULL表示给空树建根。
+// 成功返回新节点，位置已被占用返回NULL
+AugTNode *AugInsertLeaf(AugTree *root, AugTNode *p, int left, int val) {
+    AugTNode **slot = p == NULL ? root : (left ? &p->lchild : &p->rchild);
+    if (*slot != NULL) return NULL;
+    *slot = NewAugNode(val, p);
+    AugFixUp(p);
+    return *slot;
+}
+
+// 释放以T为根的整棵增强树（非递归）
+void DestroyAugTree(AugTree T) {
+    PtrStack st = {NULL, 0, 0};
+    if (T) PtrPush(&st, T);
+    while (st.top > 0) {
+        AugTNode *p = (AugTNode *)PtrPop(&st);
+        if (p->lchild) PtrPush(&st, p->lchild);
+        if (p->rchild) PtrPush(&st, p->rchild);
+        free(p);
+    }
+    free(st.item);
+}
+
+// 删除以p为根的子树，并更新祖先的聚合信息
+void AugDeleteSubtree(AugTree *root, AugTNode *p) {
+    AugTNode *f;
+    if (p == NULL) return;
+    f = p->parent;
+    if (f == NULL) *root = NULL;
+    else if (f->lchild == p) f->lchild = NULL;
+    else f->rchild = NULL;
+    DestroyAugTree(p);
+    AugFixUp(f);
+}
+
+// O(1)查询：结果与GetTreeHeight、CountLeaf、IsCompleteBiTree一致
+int AugHeight(AugTree T) {
+    return T ? T->height : 0;
+}
+
+int64_t AugSize(AugTree T) {
+    return T ? T->size : 0;
+}
+
+int64_t AugLeaves(AugTree T) {
+    return T ? T->leaves : 0;
+}
+
+int AugIsComplete(AugTree T) {
+    return T ? T->complete : 1;
+}
+
+// ====================== 13. 值→节点的哈希索引（开放定址，支持重复值） ======================
+// 线性探测哈希表，每个不同的值占一个槽：只有一个节点时直接存在槽里，有重复时槽里指向该值的节点数组。
+// 探测长度只与不同值的个数有关，重复再多也不会在表里连成一片、拖慢别的值。
+// 负载因子不超过1/2，满了翻倍重建；删除用后移填补，不留墓碑。
+// 用UseNodeIndex挂上索引后，NewBiTNode/FreeBiTNode（以及CreateBiTree、DestroyBiTree）会自动维护它；
+// 节点池里的树（LoadBiTree、RandomBiTree）用IndexBuild一次建好。
+// 注意：有重复值时IndexFind返回其中任意一个，不一定是FindNode的先序第一个。
+typedef struct {
+    int key;
+    uint32_t count;     // 值为key的节点数，0表示空槽
+    union {
+        BiTree one;     // count为1：节点本身
+        BiTree *many;   // count>1：节点数组，容量是不小于count的2的幂
+    } u;
+} IndexSlot;
+
+typedef struct {
+    IndexSlot *slot;
+    uint64_t mask;      // 容量-1，容量是2的幂
+    uint64_t keys;      // 占用的槽数（不同值的个数）
+    uint64_t count;     // 登记的节点数
+    int bits;           // 容量 = 2^bits
+} NodeIndex;
+
+static NodeIndex *node_index = NULL;    // NewBiTNode/FreeBiTNode当前维护的索引
+
+static uint64_t IndexHash(const NodeIndex *ix, int key) {
+    return ((uint64_t)(uint32_t)key * 0x9E3779B97F4A7C15ULL) >> (64 - ix->bits);
+}
+
+static void IndexAlloc(NodeIndex *ix, int bits) {
+    ix->bits = bits;
+    ix->mask = ((uint64_t)1 << bits) - 1;
+    ix->keys = ix->count = 0;
+    ix->slot = (IndexSlot *)calloc(ix->mask + 1, sizeof(IndexSlot));
+    if (ix->slot == NULL) {
+        printf("错误！内存分配失败\n");
+        exit(1);
+    }
+}
+
+void IndexInit(NodeIndex *ix) {
+    IndexAlloc(ix, 4);
+}
+
+void IndexFree(NodeIndex *ix) {
+    uint64_t i;
+    if (node_index == ix) node_index = NULL;
+    for (i = 0; ix->slot && i <= ix->mask; i++) {
+        if (ix->slot[i].count > 1) free(ix->slot[i].u.many);
+    }
+    free(ix->slot);
+    ix->slot = NULL;
+    ix->mask = ix->keys = ix->count = 0;
+}
+
+// 值key所在的槽；没有时返回它应放入的空槽
+static IndexSlot *IndexSlotOf(const NodeIndex *ix, int key) {
+    uint64_t i = IndexHash(ix, key);
+    while (ix->slot[i].count != 0 && ix->slot[i].key != key) i = (i + 1) & ix->mask;
+    return &ix->slot[i];
+}
+
+static BiTree *SlotNodes(IndexSlot *s) {
+    return s->count == 1 ? &s->u.one : s->u.many;
+}
+
+// 登记节点p（按p->data）
+void IndexAdd(NodeIndex *ix, BiTree p) {
+    IndexSlot *s = IndexSlotOf(ix, p->data);
+
+    if (s->count == 0 && 2 * (ix->keys + 1) > ix->mask + 1) {     // 新值且超过一半：翻倍重建
+        NodeIndex big;
+        uint64_t i;
+        IndexAlloc(&big, ix->bits + 1);
+        for (i = 0; i <= ix->mask; i++) {
+            if (ix->slot[i].count) *IndexSlotOf(&big, ix->slot[i].key) = ix->slot[i];
+        }
+        big.keys = ix->keys;
+        big.count = ix->count;
+        free(ix->slot);
+        *ix = big;
+        s = IndexSlotOf(ix, p->data);
+    }
+    if (s->count == 0) {
+        s->key = p->data;
+        s->u.one = p;
+        ix->keys++;
+    } else {
+        // 数组满（count是2的幂）时翻倍；从1个变成2个时才第一次分配
+        if ((s->count & (s->count - 1)) == 0) {
+            BiTree *v = (BiTree *)malloc(2 * (size_t)s->count * sizeof(BiTree));
+            if (v == NULL) {
+                printf("错误！内存分配失败\n");
+                exit(1);
+            }
+            memcpy(v, SlotNodes(s), (size_t)s->count * sizeof(BiTree));
+            if (s->count > 1) free(s->u.many);
+            s->u.many = v;
+        }
+        s->u.many[s->count] = p;
+    }
+    s->count++;
+    ix->count++;
+}
+
+// 注销节点p，成功返回1。在该值的节点数组里找到p，用最后一个填上它的位置；
+// 该值没有节点了就删掉槽，把同一探测链上后面的槽前移填空
+int IndexRemove(NodeIndex *ix, BiTree p) {
+    IndexSlot *s = IndexSlotOf(ix, p->data);
+    BiTree *v;
+    uint64_t i, j, h;
+    uint32_t k;
+
+    if (s->count == 0) return 0;
+    v = SlotNodes(s);
+    for (k = s->count; k > 0 && v[k - 1] != p; k--) {}   // 从后往前找，刚登记的节点先被找到
+    if (k == 0) return 0;
+    ix->count--;
+    if (s->count > 1) {
+        v[k - 1] = v[s->count - 1];
+        if (--s->count == 1) {
+            BiTree last = v[0];
+            free(v);
+            s->u.one = last;
+        }
+        return 1;
+    }
+    s->count = 0;
+    ix->keys--;
+    i = (uint64_t)(s - ix->slot);
+    for (j = (i + 1) & ix->mask; ix->slot[j].count != 0; j = (j + 1) & ix->mask) {
+        h = IndexHash(ix, ix->slot[j].key);
+        if (((j - h) & ix->mask) >= ((j - i) & ix->mask)) {    // j的理想位置不在(i, j]之间，可以移到i
+            ix->slot[i] = ix->slot[j];
+            i = j;
+        }
+    }
+    ix->slot[i].count = 0;
+    return 1;
+}
+
+// 查找值为val的节点（平均O(1)），没有返回NULL
+BiTree IndexFind(const NodeIndex *ix, int val) {
+    IndexSlot *s = IndexSlotOf(ix, val);
+    return s->count ? SlotNodes(s)[0] : NULL;
+}
+
+// 取出所有值为val的节点，最多写cap个到out，返回实际个数
+int64_t IndexFindAll(const NodeIndex *ix, int val, BiTree *out, int64_t cap) {
+    IndexSlot *s = IndexSlotOf(ix, val);
+    int64_t k = s->count;
+    if (k > 0 && cap > 0) memcpy(out, SlotNodes(s), (size_t)(k < cap ? k : cap) * sizeof(BiTree));
+    return k;
+}
+
+// 把已有的整棵树登记到索引里（非递归）
+void IndexBuild(NodeIndex *ix, BiTree T) {
+    PtrStack st = {NULL, 0, 0};
+    if (T) PtrPush(&st, T);
+    while (st.top > 0) {
+        BiTree p = (BiTree)PtrPop(&st);
+        IndexAdd(ix, p);
+        if (p->rchild) PtrPush(&st, p->rchild);
+        if (p->lchild) PtrPush(&st, p->lchild);
+    }
+    free(st.item);
+}
+
+// 索引占用的字节数：哈希表加上重复值的节点数组（数组容量按不小于count的2的幂计）
+size_t IndexMemory(const NodeIndex *ix) {
+    size_t bytes = (size_t)(ix->mask + 1) * sizeof(IndexSlot);
+    uint64_t i;
+    for (i = 0; i <= ix->mask; i++) {
+        uint32_t c = ix->slot[i].count, cap = 1;
+        if (c < 2) continue;
+        while (cap < c) cap *= 2;
+        bytes += cap * sizeof(BiTree);
+    }
+    return bytes;
+}
+
+// 指定之后NewBiTNode/FreeBiTNode维护的索引（NULL表示不维护）
+void UseNodeIndex(NodeIndex *ix) {
+    node_index = ix;
+}
+
+BiTree NewBiTNode(int val) {
+    BiTree p = (BiTree)malloc(sizeof(BiTNode));
+    if (p == NULL) {
+        printf("错误！内存分配失败\n");
+        exit(1);
+    }
+    p->data = val;
+    p->lchild = p->rchild = NULL;
+    if (node_index) IndexAdd(node_index, p);
+    return p;
+}
+
+void FreeBiTNode(BiTree p) {
+    if (node_index) IndexRemove(node_index, p);
+    free(p);
+}
+
+// 释放由NewBiTNode/CreateBiTree建立的整棵树（非递归）
+void DestroyBiTree(BiTree T) {
+    PtrStack st = {NULL, 0, 0};
+    if (T) PtrPush(&st, T);
+    while (st.top > 0) {
+        BiTree p = (BiTree)PtrPop(&st);
+        if (p->lchild) PtrPush(&st, p->lchild);
+        if (p->rchild) PtrPush(&st, p->rchild);
+        FreeBiTNode(p);
+    }
+    free(st.item);
+}
+
+// ====================== 14. 线索二叉树：标志位压在指针最低位 ======================
+// 全线索化：左指针为空时改指中序前驱，右指针为空时改指中序后继。
+// 节点至少按4字节对齐，指针最低位恒为0，借来做标志：1表示线索，0表示孩子。
+// 第一个节点的左线索和最后一个节点的右线索为NULL。
+// 这样中序（和逆中序）遍历只需沿指针走，不用递归也不用栈，每步均摊O(1)。
+typedef struct ThrNode {
+    int data;
+    uintptr_t lchild;   // 孩子指针或前驱线索（最低位为1）
+    uintptr_t rchild;   // 孩子指针或后继线索（最低位为1）
+} ThrNode, *ThrTree;
+
+#define THR_TAG 1
+#define THR_IS_THREAD(x) ((x) & THR_TAG)
+#define THR_PTR(x) ((ThrNode *)((x) & ~(uintptr_t)THR_TAG))
+
+// 把普通二叉树复制成线索二叉树，节点放在一整块内存里，*pool返回首地址（用完free(*pool)）
+ThrTree ToThrTree(BiTree T, ThrNode **pool) {
+    PtrStack st = {NULL, 0, 0};
+    ThrNode *nodes, *prev = NULL, *q;
+    uint64_t cnt = CountNodes(T), used = 0;
+
+    *pool = NULL;
+    if (!T) return NULL;
+    nodes = (ThrNode *)malloc(cnt * sizeof(ThrNode));
+    if (nodes == NULL) {
+        printf("错误！内存分配失败\n");
+        exit(1);
+    }
+    // 第一步：按先序复制结构（成对入栈：原节点、新节点）
+    nodes[used].data = T->data;
+    PtrPush(&st, T);
+    PtrPush(&st, &nodes[used++]);
+    while (st.top > 0) {
+        q = (ThrNode *)PtrPop(&st);
+        BiTree p = (BiTree)PtrPop(&st);
+        q->lchild = q->rchild = 0;
+        if (p->rchild) {
+            nodes[used].data = p->rchild->data;
+            q->rchild = (uintptr_t)&nodes[used];
+            PtrPush(&st, p->rchild);
+            PtrPush(&st, &nodes[used++]);
+        }
+        if (p->lchild) {
+            nodes[used].data = p->lchild->data;
+            q->lchild = (uintptr_t)&nodes[used];
+            PtrPush(&st, p->lchild);
+            PtrPush(&st, &nodes[used++]);
+        }
+    }
+    // 第二步：中序走一遍，把空指针改成线索
+    q = nodes;
+    while (q || st.top > 0) {
+        while (q) {
+            PtrPush(&st, q);
+            q = THR_PTR(q->lchild);
+        }
+        q = (ThrNode *)PtrPop(&st);
+        if (q->lchild == 0) q->lchild = (uintptr_t)prev | THR_TAG;
+        if (prev && prev->rchild == 0) prev->rchild = (uintptr_t)q | THR_TAG;
+        prev = q;
+        q = THR_PTR(q->rchild);             // 右边要么是孩子，要么还是0（线索在访问后继时才填）
+    }
+    prev->rchild = (uintptr_t)NULL | THR_TAG;
+    free(st.item);
+    *pool = nodes;
+    return nodes;
+}
+
+// 中序第一个/最后一个节点
+ThrNode *ThrFirst(ThrTree T) {
+    if (!T) return NULL;
+    while (!THR_IS_THREAD(T->lchild)) T = THR_PTR(T->lchild);
+    return T;
+}
+
+ThrNode *ThrLast(ThrTree T) {
+    if (!T) return NULL;
+    while (!THR_IS_THREAD(T->rchild)) T = THR_PTR(T->rchild);
+    return T;
+}
+
+// 中序后继：右边是线索就直接跳过去，否则是右子树的最左节点
+ThrNode *ThrNext(ThrNode *p) {
+    uintptr_t r = p->rchild;
+    if (THR_IS_THREAD(r)) return THR_PTR(r);
+    p = THR_PTR(r);
+    while (!THR_IS_THREAD(p->lchild)) p = THR_PTR(p->lchild);
+    return p;
+}
+
+// 中序前驱：与后继对称
+ThrNode *ThrPrev(ThrNode *p) {
+    uintptr_t l = p->lchild;
+    if (THR_IS_THREAD(l)) return THR_PTR(l);
+    p = THR_PTR(l);
+    while (!THR_IS_THREAD(p->rchild)) p = THR_PTR(p->rchild);
+    return p;
+}
+
+// 中序遍历与逆中序遍历（输出格式同InOrder）
+void ThrInOrder(ThrTree T) {
+    ThrNode *p;
+    for (p = ThrFirst(T); p; p = ThrNext(p)) printf("%d", p->data);
+}
+
+void ThrRevInOrder(ThrTree T) {
+    ThrNode *p;
+    for (p = ThrLast(T); p; p = ThrPrev(p)) printf("%d", p->data);
+}
+
+// ====================== 15. 简洁（succinct）编码：层序位图 + rank/select ======================
+// Jacobson的层序编码：按层序给节点编号0..n-1，第i个节点占位图的第2i位（有左孩子）和第2i+1位（有右孩子），共2n位。
+// 层序中孩子出现的顺序与位图中1出现的顺序相同，所以：
+//   左孩子(i)  = rank1(2i) + 1      （位2i为1时）
+//   右孩子(i)  = rank1(2i+1) + 1    （位2i+1为1时）
+//   父节点(j)  = select1(j) / 2     （第j个1所在位置，j>0）
+// rank用rank9目录（每512位两个64位字，额外25%），select在每512个1的采样块之间二分。
+// 子树规模：子树在每一层占连续的一段层序编号，[l, r]的孩子是[rank1(2l)+1, rank1(2r+2)]，逐层累加。
+// 节点值减去最小值后按w位紧凑存放。
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define POPCNT64(x) ((int)__popcnt64(x))
+static int CTZ64(uint64_t x) { unsigned long i; _BitScanForward64(&i, x); return (int)i; }
+static int LOG2_32(unsigned int x) { unsigned long i; _BitScanReverse(&i, x); return (int)i; }
+#else
+#define POPCNT64(x) __builtin_popcountll(x)
+#define CTZ64(x) __builtin_ctzll(x)
+#define LOG2_32(x) (31 - __builtin_clz(x))
+#endif
+
+typedef struct {
+    int64_t count;          // 节点数n
+    uint64_t *bits;         // 2n位孩子位图
+    int64_t words;          // 位图的64位字数
+    uint64_t *rank;         // rank9目录：rank[2b]为第b块之前1的个数，rank[2b+1]为块内第1..7个字之前的计数（各9位）
+    int64_t blocks;         // 512位块数
+    int64_t *sel;           // sel[s]：第s*512+1个1所在的块号
+    int64_t samples;
+    uint64_t *vals;         // 紧凑值数组
+    int width;              // 每个值的位数（0表示全部等于vmin）
+    int vmin;
+} SuccinctTree;
+
+#define SUCC_BIT(s, pos) (((s)->bits[(pos) >> 6] >> ((pos) & 63)) & 1)
+
+// [0, pos)中1的个数
+int64_t SuccRank1(const SuccinctTree *s, int64_t pos) {
+    int64_t w = pos >> 6, b = w >> 3, k = w & 7;
+    int64_t r = (int64_t)s->rank[2 * b];
+    if (k > 0) r += (int64_t)((s->rank[2 * b + 1] >> (9 * (k - 1))) & 0x1FF);
+    if (pos & 63) r += POPCNT64(s->bits[w] & (((uint64_t)1 << (pos & 63)) - 1));
+    return r;
+}
+
+// 第j个1（j从1开始）所在的位置
+int64_t SuccSelect1(const SuccinctTree *s, int64_t j) {
+    int64_t t = (j - 1) >> 9, lo = s->sel[t], hi = t + 1 < s->samples ? s->sel[t + 1] : s->blocks - 1;
+    int64_t rem, w;
+    uint64_t x, c;
+    int k;
+
+    while (lo < hi) {                               // 最后一个rank[2b] < j的块
+        int64_t mid = (lo + hi + 1) / 2;
+        if ((int64_t)s->rank[2 * mid] < j) lo = mid;
+        else hi = mid - 1;
+    }
+    rem = j - (int64_t)s->rank[2 * lo];
+    for (k = 7; k > 0; k--) {                       // 块内：最后一个相对计数 < rem 的字
+        if ((int64_t)((s->rank[2 * lo + 1] >> (9 * (k - 1))) & 0x1FF) < rem) break;
+    }
+    if (k > 0) rem -= (int64_t)((s->rank[2 * lo + 1] >> (9 * (k - 1))) & 0x1FF);
+    w = lo * 8 + k;
+    x = s->bits[w];
+    for (k = 0; (int64_t)(c = POPCNT64(x & 0xFF)) < rem; k += 8) {   // 先按字节跳
+        rem -= (int64_t)c;
+        x >>= 8;
+    }
+    while (--rem > 0) x &= x - 1;                   // 字节内再逐个去掉低位的1
+    return w * 64 + k + CTZ64(x);
+}
+
+// 由BiTree建立简洁编码（用循环队列做层序），成功返回1
+int BuildSuccinct(SuccinctTree *s, BiTree T) {
+    SqQueue q;
+    BiTree p;
+    int64_t i = 0, b, k, acc;
+    int vmax;
+    uint64_t range;
+
+    memset(s, 0, sizeof(*s));
+    s->count = (int64_t)CountNodes(T);
+    s->words = (2 * s->count + 63) / 64;
+    s->blocks = s->words / 8 + 1;
+    s->bits = (uint64_t *)calloc((size_t)s->blocks * 8, sizeof(uint64_t));   // 按整块分配，补零
+    s->rank = (uint64_t *)malloc((size_t)s->blocks * 2 * sizeof(uint64_t));
+    if (s->bits == NULL || s->rank == NULL) return 0;
+    if (s->count == 0) {
+        s->rank[0] = s->rank[1] = 0;
+        return 1;
+    }
+
+    // 值的范围决定位宽
+    s->vmin = vmax = T->data;
+    InitQueue(&q);
+    EnQueue(&q, T);
+    while (DeQueue(&q, &p)) {
+        if (p->data < s->vmin) s->vmin = p->data;
+        if (p->data > vmax) vmax = p->data;
+        if (p->lchild) EnQueue(&q, p->lchild);
+        if (p->rchild) EnQueue(&q, p->rchild);
+    }
+    range = (uint64_t)((int64_t)vmax - s->vmin);
+    while (s->width < 64 && (range >> s->width) != 0) s->width++;
+    s->vals = (uint64_t *)calloc((size_t)((s->count * s->width + 63) / 64 + 1), sizeof(uint64_t));
+    if (s->vals == NULL) {
+        DestroyQueue(&q);
+        return 0;
+    }
+
+    // 层序填位图和值
+    EnQueue(&q, T);
+    while (DeQueue(&q, &p)) {
+        uint64_t v = (uint64_t)((int64_t)p->data - s->vmin);
+        int64_t bit = i * s->width;
+        if (s->width > 0) {
+            s->vals[bit >> 6] |= v << (bit & 63);
+            if ((bit & 63) + s->width > 64) s->vals[(bit >> 6) + 1] |= v >> (64 - (bit & 63));
+        }
+        if (p->lchild) {
+            s->bits[(2 * i) >> 6] |= (uint64_t)1 << ((2 * i) & 63);
+            EnQueue(&q, p->lchild);
+        }
+        if (p->rchild) {
+            s->bits[(2 * i + 1) >> 6] |= (uint64_t)1 << ((2 * i + 1) & 63);
+            EnQueue(&q, p->rchild);
+        }
+        i++;
+    }
+    DestroyQueue(&q);
+
+    // rank9目录
+    acc = 0;
+    for (b = 0; b < s->blocks; b++) {
+        uint64_t rel = 0;
+        int64_t in = 0;
+        s->rank[2 * b] = (uint64_t)acc;
+        for (k = 0; k < 8; k++) {
+            if (k > 0) rel |= (uint64_t)in << (9 * (k - 1));
+            in += POPCNT64(s->bits[b * 8 + k]);
+        }
+        s->rank[2 * b + 1] = rel;
+        acc += in;
+    }
+
+    // select采样：第t*512+1个1所在的块
+    s->samples = (acc + 511) / 512;
+    s->sel = (int64_t *)malloc((size_t)(s->samples + 1) * sizeof(int64_t));
+    if (s->sel == NULL) return 0;
+    for (b = 0, k = 0; k < s->samples; k++) {
+        while (b + 1 < s->blocks && (int64_t)s->rank[2 * (b + 1)] < k * 512 + 1) b++;
+        s->sel[k] = b;
+    }
+    return 1;
+}
+
+void FreeSuccinct(SuccinctTree *s) {
+    free(s->bits);
+    free(s->rank);
+    free(s->sel);
+    free(s->vals);
+    memset(s, 0, sizeof(*s));
+}
+
+// 导航：参数和返回值都是层序编号，不存在返回-1
+int64_t SuccLeft(const SuccinctTree *s, int64_t i) {
+    return SUCC_BIT(s, 2 * i) ? SuccRank1(s, 2 * i) + 1 : -1;
+}
+
+int64_t SuccRight(const SuccinctTree *s, int64_t i) {
+    return SUCC_BIT(s, 2 * i + 1) ? SuccRank1(s, 2 * i + 1) + 1 : -1;
+}
+
+int64_t SuccParent(const SuccinctTree *s, int64_t i) {
+    return i > 0 ? SuccSelect1(s, i) / 2 : -1;
+}
+
+int SuccValue(const SuccinctTree *s, int64_t i) {
+    int64_t bit = i * s->width;
+    uint64_t v;
+    if (s->width == 0) return s->vmin;
+    v = s->vals[bit >> 6] >> (bit & 63);
+    if ((bit & 63) + s->width > 64) v |= s->vals[(bit >> 6) + 1] << (64 - (bit & 63));
+    if (s->width < 64) v &= ((uint64_t)1 << s->width) - 1;
+    return (int)((int64_t)s->vmin + (int64_t)v);
+}
+
+// 以i为根的子树节点数：逐层累加层序区间长度，O(高度)次rank
+int64_t SuccSubtreeSize(const SuccinctTree *s, int64_t i) {
+    int64_t l = i, r = i, total = 0;
+    while (l <= r) {
+        total += r - l + 1;
+        l = SuccRank1(s, 2 * l) + 1;
+        r = SuccRank1(s, 2 * r + 2);
+    }
+    return total;
+}
+
+// 编码占用的字节数
+size_t SuccMemory(const SuccinctTree *s) {
+    return (size_t)s->blocks * 8 * sizeof(uint64_t) + (size_t)s->blocks * 2 * sizeof(uint64_t)
+           + (size_t)(s->samples + 1) * sizeof(int64_t)
+           + (size_t)((s->count * s->width + 63) / 64 + 1) * sizeof(uint64_t);
+}
+
+// ====================== 16. 最近公共祖先（LCA）与路径长度：O(1)查询 ======================
+// 节点按先序编号0..n-1（即CreateBiTree读入的次序）。对u<v，先序区间(u, v]中深度最小的节点
+// 一定是LCA的孩子，因此 LCA(u, v) = parent(区间(u, v]中深度最小者)。这是欧拉序+RMQ的简化版：
+// 数组只有n项而不是2n-1项。
+// 区间最小值（RMQ）：每64个位置一块，块间用稀疏表（O(n/64 · log n)空间）；块内每个位置存一个64位掩码，
+// 记录处理到该位置时单调栈中的位置，查询块内[l, r]就是 mask[r] 去掉l以下的位后取最低位。
+// 距离（边数）= depth[u] + depth[v] - 2·depth[LCA]。
+#define LCA_BLOCK 64
+
+typedef struct {
+    int count;
+    BiTree *node;           // 编号 -> 节点
+    int *parent;            // 编号 -> 父节点编号（根为-1）
+    int *depth;             // 编号 -> 深度（根为0）
+    uint64_t *mask;         // 块内单调栈掩码
+    int **table;            // table[k][b]：第b..b+2^k-1块中深度最小的位置
+    int levels;
+    int blocks;
+} LcaIndex;
+
+static int LcaMinPos(const LcaIndex *x, int a, int b) {
+    return x->depth[b] < x->depth[a] ? b : a;
+}
+
+// 块内[l, r]（同一块）深度最小的位置
+static int LcaInBlock(const LcaIndex *x, int l, int r) {
+    uint64_t m = x->mask[r] & (~(uint64_t)0 << (l % LCA_BLOCK));
+    return r - r % LCA_BLOCK + CTZ64(m);
+}
+
+// [l, r]中深度最小的位置
+static int LcaRmq(const LcaIndex *x, int l, int r) {
+    int bl = l / LCA_BLOCK, br = r / LCA_BLOCK, best, k;
+    if (bl == br) return LcaInBlock(x, l, r);
+    best = LcaMinPos(x, LcaInBlock(x, l, bl * LCA_BLOCK + LCA_BLOCK - 1), LcaInBlock(x, br * LCA_BLOCK, r));
+    if (bl + 1 < br) {
+        int len = br - bl - 1;
+        k = LOG2_32((unsigned int)len);
+        best = LcaMinPos(x, best, x->table[k][bl + 1]);
+        best = LcaMinPos(x, best, x->table[k][br - (1 << k)]);
+    }
+    return best;
+}
+
+void FreeLca(LcaIndex *x) {
+    int k;
+    for (k = 0; k < x->levels; k++) free(x->table[k]);
+    free(x->table);
+    free(x->node);
+    free(x->parent);
+    free(x->depth);
+    free(x->mask);
+    memset(x, 0, sizeof(*x));
+}
+
+// 预处理：O(n)时间，成功返回1
+int BuildLca(LcaIndex *x, BiTree T) {
+    typedef struct { BiTree p; int parent, depth; } Job;
+    Job *stk;
+    int n, top = 0, used = 0, i, b, k, *st, sp;
+
+    memset(x, 0, sizeof(*x));
+    n = x->count = (int)CountNodes(T);
+    if (n == 0) return 1;
+    x->node = (BiTree *)malloc((size_t)n * sizeof(BiTree));
+    x->parent = (int *)malloc((size_t)n * sizeof(int));
+    x->depth = (int *)malloc((size_t)n * sizeof(int));
+    x->mask = (uint64_t *)malloc((size_t)n * sizeof(uint64_t));
+    stk = (Job *)malloc((size_t)n * sizeof(Job));
+    if (x->node == NULL || x->parent == NULL || x->depth == NULL || x->mask == NULL || stk == NULL) {
+        free(stk);
+        FreeLca(x);
+        return 0;
+    }
+
+    // 非递归先序编号
+    stk[top].p = T;
+    stk[top].parent = -1;
+    stk[top++].depth = 0;
+    while (top > 0) {
+        Job j = stk[--top];
+        x->node[used] = j.p;
+        x->parent[used] = j.parent;
+        x->depth[used] = j.depth;
+        if (j.p->rchild) {
+            stk[top].p = j.p->rchild;
+            stk[top].parent = used;
+            stk[top++].depth = j.depth + 1;
+        }
+        if (j.p->lchild) {
+            stk[top].p = j.p->lchild;
+            stk[top].parent = used;
+            stk[top++].depth = j.depth + 1;
+        }
+        used++;
+    }
+
+    // 块内单调栈掩码（栈中深度严格递增）
+    st = (int *)stk;            // Job数组已用完，借来当单调栈
+    for (b = 0; b < n; b += LCA_BLOCK) {
+        uint64_t m = 0;
+        sp = 0;
+        for (i = b; i < n && i < b + LCA_BLOCK; i++) {
+            while (sp > 0 && x->depth[st[sp - 1]] >= x->depth[i]) {
+                m &= ~((uint64_t)1 << (st[--sp] - b));
+            }
+            st[sp++] = i;
+            m |= (uint64_t)1 << (i - b);
+            x->mask[i] = m;
+        }
+    }
+    free(stk);
+
+    // 块间稀疏表
+    x->blocks = (n + LCA_BLOCK - 1) / LCA_BLOCK;
+    for (x->levels = 1; (1 << x->levels) <= x->blocks; x->levels++) {
+    }
+    x->table = (int **)calloc((size_t)x->levels, sizeof(int *));
+    if (x->table == NULL) {
+        FreeLca(x);
+        return 0;
+    }
+    for (k = 0; k < x->levels; k++) {
+        int len = x->blocks - (1 << k) + 1;
+        x->table[k] = (int *)malloc((size_t)len * sizeof(int));
+        if (x->table[k] == NULL) {
+            FreeLca(x);
+            return 0;
+        }
+        for (b = 0; b < len; b++) {
+            if (k == 0) {
+                int end = b * LCA_BLOCK + LCA_BLOCK - 1 < n ? b * LCA_BLOCK + LCA_BLOCK - 1 : n - 1;
+                x->table[0][b] = LcaInBlock(x, b * LCA_BLOCK, end);
+            } else {
+                x->table[k][b] = LcaMinPos(x, x->table[k - 1][b], x->table[k - 1][b + (1 << (k - 1))]);
+            }
+        }
+    }
+    return 1;
+}
+
+// 编号为u、v的两个节点的最近公共祖先编号
+int LcaQuery(const LcaIndex *x, int u, int v) {
+    if (u == v) return u;
+    if (u > v) {
+        int t = u;
+        u = v;
+        v = t;
+    }
+    return x->parent[LcaRmq(x, u + 1, v)];
+}
+
+// 两节点之间路径的边数
+int TreeDistance(const LcaIndex *x, int u, int v) {
+    return x->depth[u] + x->depth[v] - 2 * x->depth[LcaQuery(x, u, v)];
+}
+
+// 批量查询：lca[i] = LCA(u[i], v[i])，dist不为NULL时同时给出距离
+void LcaBatch(const LcaIndex *x, const int *u, const int *v, int *lca, int *dist, int64_t cnt) {
+    int64_t i;
+    for (i = 0; i < cnt; i++) {
+        int a = LcaQuery(x, u[i], v[i]);
+        lca[i] = a;
+        if (dist) dist[i] = x->depth[u[i]] + x->depth[v[i]] - 2 * x->depth[a];
+    }
+}
+
+// ====================== 17. 相同子树合并（hash-consing）：二叉树 -> 共享DAG ======================
+// 自底向上处理：节点的身份由(值, 规范化后的左孩子指针, 规范化后的右孩子指针)决定，
+// 相同三元组只保留一个节点，于是结构和值都相同的子树自然共享同一份。
+// 结果仍由普通BiTNode组成（只读共享），所以各种遍历、GetTreeHeight、CountLeaf不用改就能用，
+// 只是共享部分会被重复访问。引用计数（DAG中的入边数，根另加1）放在与节点块平行的数组里，
+// 不占BiTNode的空间；查重用的哈希表只在DagIntern期间存在，合并完就释放，下次调用时按现有节点重建。
+#define DAG_CHUNK 65536     // 节点按块分配，扩容时已有节点不移动
+
+typedef struct {
+    BiTree node;            // NULL表示空槽
+    uint64_t hash;
+} DagSlot;
+
+typedef struct {
+    BiTNode *node;
+    uint32_t *ref;          // ref[i]是node[i]的引用数，0表示空闲节点
+} DagChunk;
+
+typedef struct {
+    DagSlot *slot;          // 查重用的哈希表（只在DagIntern期间存在）
+    uint64_t mask;          // 哈希表容量-1
+    uint64_t count;         // DAG中的节点数
+    DagChunk *chunk;        // 节点块，按地址排序，节点所在的块用二分查找
+    int chunks, cur;        // 块数、正在分配的块
+    int64_t used;           // 正在分配的块已用的节点数
+    BiTree free_list;       // 释放后的节点，用lchild串起来
+    size_t table_peak;      // 哈希表最大时占用的字节数
+} TreeDag;
+
+static uint64_t DagHash(int data, BiTree l, BiTree r) {
+    uint64_t h = (uint64_t)(uint32_t)data * 0x9E3779B97F4A7C15ULL;
+    h ^= (uint64_t)(uintptr_t)l * 0xC2B2AE3D27D4EB4FULL;
+    h ^= (uint64_t)(uintptr_t)r * 0x165667B19E3779F9ULL;
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDULL;
+    h ^= h >> 33;
+    return h;
+}
+
+static void DagAllocTable(TreeDag *d, uint64_t cap) {
+    d->slot = (DagSlot *)calloc(cap, sizeof(DagSlot));
+    if (d->slot == NULL) {
+        printf("错误！内存分配失败\n");
+        exit(1);
+    }
+    d->mask = cap - 1;
+    if (cap * sizeof(DagSlot) > d->table_peak) d->table_peak = cap * sizeof(DagSlot);
+}
+
+void InitDag(TreeDag *d) {
+    memset(d, 0, sizeof(*d));
+}
+
+void FreeDag(TreeDag *d) {
+    int i;
+    for (i = 0; i < d->chunks; i++) {
+        free(d->chunk[i].node);
+        free(d->chunk[i].ref);
+    }
+    free(d->chunk);
+    free(d->slot);
+    memset(d, 0, sizeof(*d));
+}
+
+// 节点p（必须来自本DAG）的引用数所在位置：二分找到起始地址不超过p的最后一块
+static uint32_t *DagRefOf(const TreeDag *d, BiTree p) {
+    int lo = 0, hi = d->chunks - 1, mid;
+    while (lo < hi) {
+        mid = (lo + hi + 1) / 2;
+        if ((uintptr_t)d->chunk[mid].node <= (uintptr_t)p) lo = mid;
+        else hi = mid - 1;
+    }
+    return &d->chunk[lo].ref[p - d->chunk[lo].node];
+}
+
+static BiTree DagNewNode(TreeDag *d) {
+    BiTree p = d->free_list;
+    DagChunk c;
+    int k;
+
+    if (p) {
+        d->free_list = p->lchild;
+        return p;
+    }
+    if (d->chunks == 0 || d->used == DAG_CHUNK) {
+        c.node = (BiTNode *)malloc(DAG_CHUNK * sizeof(BiTNode));
+        c.ref = (uint32_t *)calloc(DAG_CHUNK, sizeof(uint32_t));
+        d->chunk = (DagChunk *)realloc(d->chunk, (size_t)(d->chunks + 1) * sizeof(DagChunk));
+        if (c.node == NULL || c.ref == NULL || d->chunk == NULL) {
+            printf("错误！内存分配失败\n");
+            exit(1);
+        }
+        // 按地址插入，保持有序
+        for (k = d->chunks; k > 0 && (uintptr_t)d->chunk[k - 1].node > (uintptr_t)c.node; k--) {
+            d->chunk[k] = d->chunk[k - 1];
+        }
+        d->chunk[k] = c;
+        d->chunks++;
+        d->cur = k;
+        d->used = 0;
+    }
+    return &d->chunk[d->cur].node[d->used++];
+}
+
+// 找(data, l, r)对应的槽：找到返回该槽，否则返回应插入的空槽
+static DagSlot *DagProbe(const TreeDag *d, uint64_t h, int data, BiTree l, BiTree r) {
+    uint64_t i = h & d->mask;
+    for (; d->slot[i].node != NULL; i = (i + 1) & d->mask) {
+        BiTree q = d->slot[i].node;
+        if (d->slot[i].hash == h && q->data == data && q->lchild == l && q->rchild == r) break;
+    }
+    return &d->slot[i];
+}
+
+// 把已知不在表里的节点放进从h开始的第一个空槽
+static void DagPlace(TreeDag *d, BiTree p, uint64_t h) {
+    uint64_t j = h & d->mask;
+    while (d->slot[j].node) j = (j + 1) & d->mask;
+    d->slot[j].node = p;
+    d->slot[j].hash = h;
+}
+
+static void DagGrow(TreeDag *d) {
+    DagSlot *old = d->slot;
+    uint64_t i, cap = d->mask + 1;
+    DagAllocTable(d, cap * 2);
+    for (i = 0; i < cap; i++) {
+        if (old[i].node) DagPlace(d, old[i].node, old[i].hash);
+    }
+    free(old);
+}
+
+// 按现有节点重建哈希表（引用数为0的是空闲节点，跳过）
+static void DagBuildTable(TreeDag *d) {
+    uint64_t cap = 1024;
+    int64_t i, n;
+    int k;
+    while (cap < 2 * (d->count + 1)) cap *= 2;
+    DagAllocTable(d, cap);
+    for (k = 0; k < d->chunks; k++) {
+        n = k == d->cur ? d->used : DAG_CHUNK;
+        for (i = 0; i < n; i++) {
+            BiTree p = &d->chunk[k].node[i];
+            if (d->chunk[k].ref[i] > 0) DagPlace(d, p, DagHash(p->data, p->lchild, p->rchild));
+        }
+    }
+}
+
+// 规范化一个节点（孩子已经规范化）：已有相同节点就复用，否则新建并让孩子的引用数加1
+static BiTree DagCons(TreeDag *d, int data, BiTree l, BiTree r) {
+    uint64_t h = DagHash(data, l, r);
+    DagSlot *s = DagProbe(d, h, data, l, r);
+    if (s->node) return s->node;
+    if (2 * (d->count + 1) > d->mask + 1) {
+        DagGrow(d);
+        s = DagProbe(d, h, data, l, r);
+    }
+    s->node = DagNewNode(d);
+    s->node->data = data;
+    s->node->lchild = l;
+    s->node->rchild = r;
+    s->hash = h;
+    d->count++;
+    if (l) ++*DagRefOf(d, l);
+    if (r) ++*DagRefOf(d, r);
+    return s->node;
+}
+
+// DAG节点p的引用数（p必须来自本DAG）
+int64_t DagRef(const TreeDag *d, BiTree p) {
+    return *DagRefOf(d, p);
+}
+
+// 把树T并入DAG（原树不变），返回共享后的根；根的引用数加1。可以多次调用，不同的树之间也会共享
+BiTree DagIntern(TreeDag *d, BiTree T) {
+    PtrStack todo = {NULL, 0, 0}, done = {NULL, 0, 0};
+    BiTree root;
+
+    if (!T) return NULL;
+    DagBuildTable(d);
+    PtrPush(&todo, T);
+    while (todo.top > 0) {
+        uintptr_t x = (uintptr_t)PtrPop(&todo);
+        BiTree p = (BiTree)(x & ~(uintptr_t)1);
+        if (!(x & 1)) {                     // 第一次：孩子先处理，最低位标记“孩子已处理”
+            PtrPush(&todo, (void *)(x | 1));
+            if (p->rchild) PtrPush(&todo, p->rchild);
+            if (p->lchild) PtrPush(&todo, p->lchild);
+        } else {                            // 第二次：done栈顶依次是右、左孩子的规范节点
+            BiTree r = p->rchild ? (BiTree)PtrPop(&done) : NULL;
+            BiTree l = p->lchild ? (BiTree)PtrPop(&done) : NULL;
+            PtrPush(&done, DagCons(d, p->data, l, r));
+        }
+    }
+    root = (BiTree)PtrPop(&done);
+    ++*DagRefOf(d, root);
+    free(todo.item);
+    free(done.item);
+    free(d->slot);                          // 合并完不再需要查重
+    d->slot = NULL;
+    d->mask = 0;
+    return root;
+}
+
+// 释放一个引用：引用数归零的节点放回空闲链，并依次释放它对孩子的引用
+void DagRelease(TreeDag *d, BiTree p) {
+    PtrStack st = {NULL, 0, 0};
+    if (p) PtrPush(&st, p);
+    while (st.top > 0) {
+        BiTree q = (BiTree)PtrPop(&st);
+        if (--*DagRefOf(d, q) > 0) continue;
+        if (q->lchild) PtrPush(&st, q->lchild);
+        if (q->rchild) PtrPush(&st, q->rchild);
+        q->lchild = d->free_list;
+        d->free_list = q;
+        d->count--;
+    }
+    free(st.item);
+}
+
+// DAG占用的字节数：实际在用的节点和它们的引用计数（不算块里尚未分配和空闲的节点）
+size_t DagMemory(const TreeDag *d) {
+    return (size_t)d->count * (sizeof(BiTNode) + sizeof(uint32_t)) + (d->slot ? (size_t)(d->mask + 1) * sizeof(DagSlot) : 0);
+}
+
+// ====================== 性能测试（命令行：bench [n]） ======================
+static unsigned long long bench_seed = 88172645463325252ULL;
+static unsigned int BenchRand(void) {
+    bench_seed ^= bench_seed << 13;
+    bench_seed ^= bench_seed >> 7;
+    bench_seed ^= bench_seed << 17;
+    return (unsigned int)(bench_seed >> 32);
+}
+
+// 墙上时间（毫秒）
+static double NowMs(void) {
+#ifdef _WIN32
+    LARGE_INTEGER freq, now;
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&now);
+    return (double)now.QuadPart * 1000.0 / (double)freq.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+#endif
+}
+
+// 在节点池中生成cnt个节点的随机二叉树：每个子树随机划分左右规模（非递归）
+BiTree RandomBiTree(BiTNode *pool, int cnt, int value_range) {
+    typedef struct { BiTree *slot; int size; } Job;
+    Job *stk;
+    BiTree root = NULL;
+    int top = 0, used = 0;
+
+    if (cnt <= 0) return NULL;
+    stk = (Job *)malloc(cnt * sizeof(Job));
+    if (stk == NULL) {
+        printf("错误！内存分配失败\n");
+        exit(1);
+    }
+    stk[top].slot = &root;
+    stk[top++].size = cnt;
+    while (top > 0) {
+        Job j = stk[--top];
+        BiTNode *p = &pool[used++];
+        int left = (int)(BenchRand() % (unsigned int)j.size);   // 左子树规模0..size-1
+        p->data = (int)(BenchRand() % (unsigned int)value_range);
+        p->lchild = p->rchild = NULL;
+        *j.slot = p;
+        if (j.size - 1 - left > 0) {
+            stk[top].slot = &p->rchild;
+            stk[top++].size = j.size - 1 - left;
+        }
+        if (left > 0) {
+            stk[top].slot = &p->lchild;
+            stk[top++].size = left;
+        }
+    }
+    free(stk);
+    return root;
+}
+
+// 先序结构+值的校验和，用来确认各种加载方式得到同一棵树
+static unsigned long long TreeChecksum(BiTree T) {
+    PtrStack st = {NULL, 0, 0};
+    unsigned long long h = 1469598103934665603ULL;
+    if (T) PtrPush(&st, T);
+    while (st.top > 0) {
+        BiTree p = (BiTree)PtrPop(&st);
+        h = (h ^ (unsigned int)p->data) * 1099511628211ULL;
+        h = (h ^ (unsigned)((p->lchild != NULL) * 2 + (p->rchild != NULL))) * 1099511628211ULL;
+        if (p->rchild) PtrPush(&st, p->rchild);
+        if (p->lchild) PtrPush(&st, p->lchild);
+    }
+    free(st.item);
+    return h;
+}
+
+static unsigned long long ViewChecksum(const BiTreeView *v) {
+    PtrStack st = {NULL, 0, 0};
+    unsigned long long h = 1469598103934665603ULL;
+    int64_t i, l, r;
+    if (v->count > 0) PtrPush(&st, (void *)(intptr_t)1);  // 栈里存下标+1，避免与NULL混淆
+    while (st.top > 0) {
+        i = (int64_t)(intptr_t)PtrPop(&st) - 1;
+        l = ViewLeft(v, i);
+        r = ViewRight(v, i);
+        h = (h ^ (unsigned int)v->vals[i]) * 1099511628211ULL;
+        h = (h ^ (unsigned)((l >= 0) * 2 + (r >= 0))) * 1099511628211ULL;
+        if (r >= 0) PtrPush(&st, (void *)(intptr_t)(r + 1));
+        if (l >= 0) PtrPush(&st, (void *)(intptr_t)(l + 1));
+    }
+    free(st.item);
+    return h;
+}
+
+// 以CreateBiTree的文本格式（先序，-1表示空）写出整棵树
+static void WriteTextTree(BiTree T, FILE *fp) {
+    PtrStack st = {NULL, 0, 0};
+    PtrPush(&st, T);
+    while (st.top > 0) {
+        BiTree p = (BiTree)PtrPop(&st);
+        if (p == NULL) {
+            fputs("-1 ", fp);
+            continue;
+        }
+        fprintf(fp, "%d ", p->data);
+        PtrPush(&st, p->rchild);
+        PtrPush(&st, p->lchild);
+    }
+    free(st.item);
+}
+
+static void ReportRate(const char *what, double ms, int64_t cnt) {
+    printf("%-28s %9.1f ms  %8.2f M节点/秒\n", what, ms, cnt / (ms / 1000.0) / 1e6);
+}
+
+// 序列化测试：保存、池化加载、mmap视图，对照scanf文本加载
+static void BenchSerialize(BiTree T, int cnt, const char *path) {
+    BiTNode *pool2 = NULL;
+    BiTree T2, T3;
+    BiTreeView view;
+    unsigned long long h = TreeChecksum(T);
+    double t0;
+    FILE *fp;
+    char txt[512];
+
+    printf("\n----- 二进制序列化（%s） -----\n", path);
+    t0 = NowMs();
+    if (!SaveBiTree(T, path)) {
+        printf("写文件失败，跳过\n");
+        remove(path);
+        return;
+    }
+    ReportRate("SaveBiTree", NowMs() - t0, cnt);
+
+    t0 = NowMs();
+    if (LoadBiTree(path, &T2, &pool2)) {
+        ReportRate("LoadBiTree（节点池）", NowMs() - t0, cnt);
+        printf("  校验：%s\n", TreeChecksum(T2) == h ? "一致" : "不一致！");
+        free(pool2);
+    }
+
+    t0 = NowMs();
+    if (MapBiTree(&view, path)) {
+        ReportRate("MapBiTree（零拷贝视图）", NowMs() - t0, cnt);
+        printf("  校验：%s\n", ViewChecksum(&view) == h ? "一致" : "不一致！");
+        UnmapBiTree(&view);
+    }
+
+    // 对照：CreateBiTree逐个scanf（从临时文本文件读，不动标准输入）
+    snprintf(txt, sizeof(txt), "%s.txt", path);
+    fp = fopen(txt, "w");
+    if (fp != NULL) {
+        WriteTextTree(T, fp);
+        fclose(fp);
+        fp = fopen(txt, "r");
+    }
+    if (fp != NULL) {
+        t0 = NowMs();
+        CreateBiTreeFrom(fp, &T3);
+        ReportRate("CreateBiTree（scanf文本）", NowMs() - t0, cnt);
+        printf("  校验：%s\n", TreeChecksum(T3) == h ? "一致" : "不一致！");
+        DestroyBiTree(T3);
+        fclose(fp);
+    }
+    remove(txt);
+    remove(path);
+}
+
+// 在节点池中生成cnt个节点的完全二叉树（按层序编号，第i个节点的孩子是2i+1、2i+2）
+BiTree CompleteTree(BiTNode *pool, int cnt) {
+    int i;
+    for (i = 0; i < cnt; i++) {
+        pool[i].data = i;
+        pool[i].lchild = 2 * (int64_t)i + 1 < cnt ? &pool[2 * i + 1] : NULL;
+        pool[i].rchild = 2 * (int64_t)i + 2 < cnt ? &pool[2 * i + 2] : NULL;
+    }
+    return cnt > 0 ? &pool[0] : NULL;
+}
+
+// 对照：队列版层序遍历，值写入数组而不是printf
+static int64_t LevelOrderQueue(BiTree T, int *out) {
+    SqQueue q;
+    BiTree p;
+    int64_t k = 0;
+    if (!T) return 0;
+    InitQueue(&q);
+    EnQueue(&q, T);
+    while (DeQueue(&q, &p)) {
+        out[k++] = p->data;
+        if (p->lchild) EnQueue(&q, p->lchild);
+        if (p->rchild) EnQueue(&q, p->rchild);
+    }
+    DestroyQueue(&q);
+    return k;
+}
+
+// 层序遍历测试：队列 vs 按层批量（单线程/多线程）
+static void BenchLevelOrder(BiTree T, int cnt, const char *name, int threads) {
+    int *out1 = (int *)malloc((size_t)cnt * sizeof(int));
+    int *out2 = (int *)malloc((size_t)cnt * sizeof(int));
+    int64_t width[64] = {0}, got;
+    double t0;
+    int lv, widest = 0, t;
+
+    if (out1 == NULL || out2 == NULL) {
+        printf("内存不足，跳过层序遍历测试\n");
+        free(out1);
+        free(out2);
+        return;
+    }
+    printf("\n----- 层序遍历（%s） -----\n", name);
+    t0 = NowMs();
+    got = LevelOrderQueue(T, out1);
+    ReportRate("循环队列（自动扩容）", NowMs() - t0, got);
+
+    // 线程数按1、2、4…翻倍，最后一轮正好是threads个
+    for (t = 1;; t = t * 2 < threads ? t * 2 : threads) {
+        char label[64];
+        t0 = NowMs();
+        got = LevelOrderFrontier(T, out2, t, width, 64);
+        snprintf(label, sizeof(label), "按层批量（%d线程）", t);
+        ReportRate(label, NowMs() - t0, got);
+        printf("  与队列版结果%s\n", memcmp(out1, out2, (size_t)got * sizeof(int)) == 0 ? "一致" : "不一致！");
+        if (t == threads) break;
+    }
+    for (lv = 0; lv < 64 && width[lv] > 0; lv++) {
+        if (width[lv] > width[widest]) widest = lv;
+    }
+    printf("  最宽一层：第%d层，%lld个节点\n", widest + 1, (long long)width[widest]);
+
+    t0 = NowMs();
+    t = IsCompleteBiTree(T);
+    printf("  IsCompleteBiTree：%s（%.1f ms）\n", t ? "是" : "否", NowMs() - t0);
+    free(out1);
+    free(out2);
+}
+
+// 并行树算法测试：递归基线 vs 工作窃取运行时（1..threads个线程）
+static void BenchParallel(BiTree T, int threads) {
+    double t0, base[3], ms[3];
+    int h, t;
+    int64_t leaf;
+    BiTree f;
+    WsPool *p;
+
+    printf("\n----- 工作窃取并行：高度 / 叶子数 / 查找（不存在的值） -----\n");
+    t0 = NowMs();
+    h = GetTreeHeight(T);
+    base[0] = NowMs() - t0;
+    t0 = NowMs();
+    leaf = CountLeaf(T);
+    base[1] = NowMs() - t0;
+    t0 = NowMs();
+    f = FindNode(T, -1);
+    base[2] = NowMs() - t0;
+    printf("递归基线：      %8.1f %8.1f %8.1f ms（高度%d，叶子%lld）\n",
+           base[0], base[1], base[2], h, (long long)leaf);
+
+    for (t = 1; t <= threads; t = (t * 2 > threads && t < threads) ? threads : t * 2) {
+        p = WsCreate(t);
+        t0 = NowMs();
+        if (ParGetTreeHeight(p, T) != h) printf("高度不一致！\n");
+        ms[0] = NowMs() - t0;
+        t0 = NowMs();
+        if (ParCountLeaf(p, T) != leaf) printf("叶子数不一致！\n");
+        ms[1] = NowMs() - t0;
+        t0 = NowMs();
+        if (ParFindNode(p, T, -1) != f) printf("查找结果不一致！\n");
+        ms[2] = NowMs() - t0;
+        printf("%2d线程：        %8.1f %8.1f %8.1f ms（加速比 %.2f / %.2f / %.2f）\n",
+               t, ms[0], ms[1], ms[2], base[0] / ms[0], base[1] / ms[1], base[2] / ms[2]);
+        WsDestroy(p);
+    }
+}
+
+// 聚合信息自检：每个节点保存的值都等于由孩子重新计算的值，且父指针正确
+static int AugVerify(AugTree T) {
+    PtrStack st = {NULL, 0, 0};
+    int ok = 1;
+    if (T) PtrPush(&st, T);
+    while (st.top > 0 && ok) {
+        AugTNode *p = (AugTNode *)PtrPop(&st), chk = *p;
+        AugPull(&chk);
+        ok = chk.height == p->height && chk.size == p->size && chk.leaves == p->leaves
+             && chk.perfect == p->perfect && chk.complete == p->complete;
+        if (p->lchild) {
+            ok = ok && p->lchild->parent == p;
+            PtrPush(&st, p->lchild);
+        }
+        if (p->rchild) {
+            ok = ok && p->rchild->parent == p;
+            PtrPush(&st, p->rchild);
+        }
+    }
+    free(st.item);
+    return ok;
+}
+
+// 增量维护测试：每次随机插入叶子或删除叶子后查询高度/叶子数/完全性，对照整树重新遍历
+static void BenchAugment(BiTree T, const char *name, int edits) {
+    AugTree A;
+    double t0, walk, ms;
+    long long sink = 0;
+    int i, h, ok;
+
+    printf("\n----- 增量维护的子树聚合（%s，%d次编辑） -----\n", name, edits);
+    t0 = NowMs();
+    h = GetTreeHeight(T);
+    sink += CountLeaf(T) + IsCompleteBiTree(T);
+    walk = NowMs() - t0;
+    printf("整树重新遍历（每次查询）：     %10.3f ms\n", walk);
+
+    t0 = NowMs();
+    A = ToAugTree(T);
+    printf("ToAugTree：                    %10.1f ms\n", NowMs() - t0);
+    ok = AugHeight(A) == h && AugLeaves(A) == CountLeaf(T) && AugIsComplete(A) == IsCompleteBiTree(T);
+    printf("  初始聚合与递归结果%s\n", ok ? "一致" : "不一致！");
+
+    t0 = NowMs();
+    for (i = 0; i < edits; i++) {
+        AugTNode *p = A;
+        if (p == NULL || (BenchRand() & 1)) {
+            // 插入：随机向下走，直到选中的孩子位置为空
+            for (;;) {
+                int left = (int)(BenchRand() & 1);
+                AugTNode *c = p == NULL ? NULL : (left ? p->lchild : p->rchild);
+                if (c == NULL) {
+                    AugInsertLeaf(&A, p, left, i);
+                    break;
+                }
+                p = c;
+            }
+        } else {
+            // 删除：随机向下走到一个叶子
+            while (p->lchild || p->rchild) {
+                if (p->lchild && p->rchild) p = (BenchRand() & 1) ? p->lchild : p->rchild;
+                else p = p->lchild ? p->lchild : p->rchild;
+            }
+            AugDeleteSubtree(&A, p);
+        }
+        sink += AugHeight(A) + AugLeaves(A) + AugIsComplete(A);
+    }
+    ms = NowMs() - t0;
+    printf("增量维护（编辑+查询，平均）：  %10.3f us（约为重新遍历的 %.0f 倍快）\n",
+           ms * 1000.0 / edits, walk / (ms / edits));
+    printf("  编辑后：%lld个节点，高度%d，叶子%lld，%s完全二叉树；自检%s（校验值%lld）\n",
+           (long long)AugSize(A), AugHeight(A), (long long)AugLeaves(A),
+           AugIsComplete(A) ? "是" : "不是", AugVerify(A) ? "通过" : "失败！", sink & 0xffff);
+    DestroyAugTree(A);
+}
+
+// 值索引测试：FindNode整树搜索 vs 哈希索引；再用NewBiTNode/DestroyBiTree验证索引随节点增删保持一致
+static void BenchIndex(BiTree T, int cnt, int queries) {
+    NodeIndex ix;
+    BiTree *all, built = NULL;
+    int *vals;
+    double t0, scan, hash;
+    int i, slow = queries < 200 ? queries : 200;   // FindNode每次要走整棵树，只测少量
+    int64_t hits = 0, bad = 0, k;
+
+    printf("\n----- 值索引：FindNode vs 开放定址哈希 -----\n");
+    vals = (int *)malloc((size_t)queries * sizeof(int));
+    if (vals == NULL) return;
+    for (i = 0; i < queries; i++) vals[i] = (int)(BenchRand() % 2000000);   // 值域是树的两倍，多数查不到
+
+    IndexInit(&ix);
+    t0 = NowMs();
+    IndexBuild(&ix, T);
+    ReportRate("IndexBuild", NowMs() - t0, cnt);
+    printf("  额外内存：%.1f MB（每节点%.1f字节，树本身每节点%d字节）\n",
+           IndexMemory(&ix) / 1048576.0, (double)IndexMemory(&ix) / cnt, (int)sizeof(BiTNode));
+
+    t0 = NowMs();
+    for (i = 0; i < slow; i++) {
+        BiTree a = FindNode(T, vals[i]), b = IndexFind(&ix, vals[i]);
+        if ((a == NULL) != (b == NULL) || (b && b->data != vals[i])) bad++;
+    }
+    scan = (NowMs() - t0) / slow;
+    t0 = NowMs();
+    for (i = 0; i < queries; i++) hits += IndexFind(&ix, vals[i]) != NULL;
+    hash = (NowMs() - t0) / queries;
+    printf("FindNode（递归搜索）：  %12.3f us/次\n", scan * 1000.0);
+    printf("IndexFind（哈希）：     %12.3f us/次（约%.0f倍快，命中%lld/%d）\n",
+           hash * 1000.0, scan / hash, (long long)hits, queries);
+    printf("  与FindNode结果%s\n", bad == 0 ? "一致" : "不一致！");
+    IndexFree(&ix);
+
+    // 节点增删：按完全二叉树编号用NewBiTNode建树（值只取1000种，制造大量重复），再整树释放
+    IndexInit(&ix);
+    UseNodeIndex(&ix);
+    all = (BiTree *)malloc((size_t)cnt * sizeof(BiTree));
+    if (all != NULL) {
+        t0 = NowMs();
+        for (i = 0; i < cnt; i++) {
+            all[i] = NewBiTNode(i % 1000);
+            if (i > 0) {
+                if (i & 1) all[(i - 1) / 2]->lchild = all[i];
+                else all[(i - 1) / 2]->rchild = all[i];
+            }
+        }
+        built = cnt > 0 ? all[0] : NULL;
+        ReportRate("NewBiTNode（1000种值）", NowMs() - t0, cnt);
+        k = IndexFindAll(&ix, 7, all, 0);
+        printf("  重复值：值7共登记%lld个节点（应为%d）\n", (long long)k, (cnt - 1 - 7) / 1000 + (cnt > 7));
+        t0 = NowMs();
+        DestroyBiTree(built);
+        ReportRate("DestroyBiTree（1000种值）", NowMs() - t0, cnt);
+        printf("  DestroyBiTree后索引剩余%llu项（应为0）\n", (unsigned long long)ix.count);
+        free(all);
+    }
+    IndexFree(&ix);
+    free(vals);
+}
+
+// 与InOrder相同的递归，只是把值写进数组（避免printf主导计时）
+static void InOrderArray(BiTree T, int *out, int64_t *k) {
+    if (T != NULL) {
+        InOrderArray(T->lchild, out, k);
+        out[(*k)++] = T->data;
+        InOrderArray(T->rchild, out, k);
+    }
+}
+
+// 线索二叉树测试：递归中序 vs 线索中序 / 逆中序
+static void BenchThreaded(BiTree T, int cnt) {
+    int *out1 = (int *)malloc((size_t)cnt * sizeof(int));
+    int *out2 = (int *)malloc((size_t)cnt * sizeof(int));
+    ThrNode *pool, *p;
+    ThrTree TT;
+    int64_t k = 0, j;
+    double t0;
+    int ok = 1;
+
+    if (out1 == NULL || out2 == NULL) {
+        printf("内存不足，跳过线索二叉树测试\n");
+        free(out1);
+        free(out2);
+        return;
+    }
+    printf("\n----- 线索二叉树：中序遍历 -----\n");
+    t0 = NowMs();
+    TT = ToThrTree(T, &pool);
+    ReportRate("ToThrTree（转换）", NowMs() - t0, cnt);
+
+    t0 = NowMs();
+    InOrderArray(T, out1, &k);
+    ReportRate("递归中序（InOrder）", NowMs() - t0, k);
+
+    t0 = NowMs();
+    for (j = 0, p = ThrFirst(TT); p; p = ThrNext(p)) out2[j++] = p->data;
+    ReportRate("线索中序（ThrNext）", NowMs() - t0, j);
+    ok = j == k && memcmp(out1, out2, (size_t)k * sizeof(int)) == 0;
+
+    t0 = NowMs();
+    for (j = 0, p = ThrLast(TT); p; p = ThrPrev(p)) out2[j++] = p->data;
+    ReportRate("线索逆中序（ThrPrev）", NowMs() - t0, j);
+    for (j = 0; ok && j < k; j++) ok = out2[j] == out1[k - 1 - j];
+    printf("  与递归中序结果%s\n", ok ? "一致" : "不一致！");
+    free(pool);
+    free(out1);
+    free(out2);
+}
+
+// 简洁编码测试：内存、正确性（与指针树逐节点对照），以及随机下行/上行/子树规模的单次延迟
+static void BenchSuccinct(BiTree T, int cnt, int steps) {
+    SuccinctTree s;
+    SqQueue q;
+    BiTree p, *lv = (BiTree *)malloc((size_t)cnt * sizeof(BiTree));
+    int64_t i, k = 0, bad = 0, x;
+    long long sink = 0;
+    double t0, ptr_ms, succ_ms;
+
+    if (lv == NULL) return;
+    printf("\n----- 简洁编码（层序位图 + rank/select） -----\n");
+    t0 = NowMs();
+    if (!BuildSuccinct(&s, T)) {
+        printf("内存不足，跳过\n");
+        free(lv);
+        return;
+    }
+    ReportRate("BuildSuccinct", NowMs() - t0, cnt);
+    printf("  内存：%.2f MB（每节点%.1f位，值%d位）；指针树%.2f MB（每节点%d位）\n",
+           SuccMemory(&s) / 1048576.0, SuccMemory(&s) * 8.0 / cnt, s.width,
+           (double)cnt * sizeof(BiTNode) / 1048576.0, (int)(8 * sizeof(BiTNode)));
+
+    // 层序下标 -> 指针，逐节点核对值、左右孩子、父节点
+    InitQueue(&q);
+    if (T) EnQueue(&q, T);
+    while (DeQueue(&q, &p)) {
+        lv[k++] = p;
+        if (p->lchild) EnQueue(&q, p->lchild);
+        if (p->rchild) EnQueue(&q, p->rchild);
+    }
+    DestroyQueue(&q);
+    for (i = 0; i < k; i++) {
+        int64_t l = SuccLeft(&s, i), r = SuccRight(&s, i);
+        if (SuccValue(&s, i) != lv[i]->data) bad++;
+        if ((l < 0 ? NULL : lv[l]) != lv[i]->lchild || (r < 0 ? NULL : lv[r]) != lv[i]->rchild) bad++;
+        if (l >= 0 && SuccParent(&s, l) != i) bad++;
+        if (r >= 0 && SuccParent(&s, r) != i) bad++;
+    }
+    for (i = 0; i < 1000 && k > 0; i++) {
+        x = (int64_t)(BenchRand() % (unsigned int)k);
+        if (SuccSubtreeSize(&s, x) != (int64_t)CountNodes(lv[x])) bad++;
+    }
+    printf("  与指针树逐节点对照：%s\n", bad == 0 ? "一致" : "不一致！");
+
+    // 随机下行：每步随机选左或右，走到空就回到根
+    bench_seed = 12345;
+    t0 = NowMs();
+    for (i = 0, p = T; i < steps; i++) {
+        BiTree c = (BenchRand() & 1) ? p->lchild : p->rchild;
+        p = c ? c : T;
+        sink += p->data;
+    }
+    ptr_ms = NowMs() - t0;
+    bench_seed = 12345;
+    t0 = NowMs();
+    for (i = 0, x = 0; i < steps; i++) {
+        int64_t c = (BenchRand() & 1) ? SuccLeft(&s, x) : SuccRight(&s, x);
+        x = c >= 0 ? c : 0;
+        sink += SuccValue(&s, x);
+    }
+    succ_ms = NowMs() - t0;
+    printf("随机下行（孩子+取值）：  指针 %6.1f ns/步，简洁 %6.1f ns/步\n",
+           ptr_ms * 1e6 / steps, succ_ms * 1e6 / steps);
+
+    t0 = NowMs();
+    for (i = 0; i < steps && k > 1; i++) sink += SuccParent(&s, 1 + (int64_t)(BenchRand() % (unsigned int)(k - 1)));
+    printf("SuccParent（select）：   %6.1f ns/次\n", (NowMs() - t0) * 1e6 / steps);
+    t0 = NowMs();
+    for (i = 0; i < steps / 100 && k > 0; i++) sink += SuccSubtreeSize(&s, (int64_t)(BenchRand() % (unsigned int)k));
+    printf("SuccSubtreeSize：        %6.1f ns/次（校验值%lld）\n", (NowMs() - t0) * 1e6 / (steps / 100), sink & 0xffff);
+    FreeSuccinct(&s);
+    free(lv);
+}
+
+// LCA测试：预处理后批量查询（O(1)）vs 沿父指针逐层上爬
+static void BenchLca(BiTree T, int cnt, int64_t queries) {
+    LcaIndex x;
+    int *u, *v, *lca, *dist;
+    int64_t i, bad = 0, slow = queries < 1000000 ? queries : 1000000;
+    double t0, fast_ms, climb_ms;
+
+    printf("\n----- LCA / 路径长度（%lld次随机查询） -----\n", (long long)queries);
+    u = (int *)malloc((size_t)queries * sizeof(int));
+    v = (int *)malloc((size_t)queries * sizeof(int));
+    lca = (int *)malloc((size_t)queries * sizeof(int));
+    dist = (int *)malloc((size_t)queries * sizeof(int));
+    t0 = NowMs();
+    if (u == NULL || v == NULL || lca == NULL || dist == NULL || !BuildLca(&x, T) || x.count == 0) {
+        printf("内存不足，跳过\n");
+        free(u);
+        free(v);
+        free(lca);
+        free(dist);
+        return;
+    }
+    ReportRate("BuildLca（预处理）", NowMs() - t0, cnt);
+    for (i = 0; i < queries; i++) {
+        u[i] = (int)(BenchRand() % (unsigned int)x.count);
+        v[i] = (int)(BenchRand() % (unsigned int)x.count);
+    }
+
+    t0 = NowMs();
+    LcaBatch(&x, u, v, lca, dist, queries);
+    fast_ms = NowMs() - t0;
+
+    // 对照：先把深的一方爬到同一深度，再一起往上爬
+    t0 = NowMs();
+    for (i = 0; i < slow; i++) {
+        int a = u[i], b = v[i];
+        while (x.depth[a] > x.depth[b]) a = x.parent[a];
+        while (x.depth[b] > x.depth[a]) b = x.parent[b];
+        while (a != b) {
+            a = x.parent[a];
+            b = x.parent[b];
+        }
+        if (a != lca[i] || dist[i] != x.depth[u[i]] + x.depth[v[i]] - 2 * x.depth[a]) bad++;
+    }
+    climb_ms = NowMs() - t0;
+    printf("LcaBatch（稀疏表+块内掩码）：%8.1f ns/次，%6.1f M次/秒\n",
+           fast_ms * 1e6 / queries, queries / (fast_ms / 1000.0) / 1e6);
+    printf("逐层上爬（前%lld次）：        %8.1f ns/次\n", (long long)slow, climb_ms * 1e6 / slow);
+    printf("  结果%s\n", bad == 0 ? "一致" : "不一致！");
+    FreeLca(&x);
+    free(u);
+    free(v);
+    free(lca);
+    free(dist);
+}
+
+// DAG压缩测试：节点数/内存节省、构建吞吐，并确认遍历、高度、叶子数与原树相同
+static void BenchDag(BiTree T, int64_t cnt, const char *name) {
+    TreeDag d;
+    BiTree D;
+    double t0;
+    int ok;
+
+    printf("\n----- 相同子树合并（%s） -----\n", name);
+    InitDag(&d);
+    t0 = NowMs();
+    D = DagIntern(&d, T);
+    ReportRate("DagIntern", NowMs() - t0, cnt);
+    printf("  节点：%lld -> %llu（%.2f%%）\n", (long long)cnt, (unsigned long long)d.count, 100.0 * d.count / cnt);
+    printf("  内存：%.2f MB -> %.2f MB（节点+引用计数；合并时哈希表最多占%.2f MB，合并完已释放）\n",
+           cnt * sizeof(BiTNode) / 1048576.0, DagMemory(&d) / 1048576.0, d.table_peak / 1048576.0);
+    ok = TreeChecksum(D) == TreeChecksum(T) && GetTreeHeight(D) == GetTreeHeight(T) && CountLeaf(D) == CountLeaf(T);
+    printf("  先序校验和、GetTreeHeight、CountLeaf：%s\n", ok ? "与原树一致" : "不一致！");
+    DagRelease(&d, D);
+    printf("  DagRelease后剩余%llu个节点（应为0）\n", (unsigned long long)d.count);
+    FreeDag(&d);
+}
+
+int RunBenchmark(int cnt, const char *path, int threads) {
+    BiTNode *pool;
+    BiTree T;
+    double t0;
+    int i;
+
+    if (cnt < 1) cnt = 1;
+    if (threads < 1) threads = 1;
+    pool = (BiTNode *)malloc((size_t)cnt * sizeof(BiTNode));
+    if (pool == NULL) {
+        printf("内存不足\n");
+        return 1;
+    }
+    t0 = NowMs();
+    T = RandomBiTree(pool, cnt, 1000000);
+    printf("===== 随机二叉树：%d个节点，生成 %.1f ms =====\n", cnt, NowMs() - t0);
+
+    BenchSerialize(T, cnt, path);
+    BenchLevelOrder(T, cnt, "随机树", threads);
+    BenchParallel(T, threads);
+    BenchAugment(T, "随机树", 100000);
+    BenchIndex(T, cnt, 1000000);
+    BenchThreaded(T, cnt);
+    BenchSuccinct(T, cnt, 10000000);
+    BenchLca(T, cnt, 10000000);
+    BenchDag(T, cnt, "随机树");
+    T = RandomBiTree(pool, cnt, 2);
+    BenchDag(T, cnt, "随机树，值只有0和1");
+    T = CompleteTree(pool, cnt);
+    BenchLevelOrder(T, cnt, "完全二叉树", threads);
+    BenchAugment(T, "完全二叉树", 100000);
+    for (i = 0; i < cnt; i++) pool[i].data = LOG2_32((unsigned int)i + 1);   // 每层同一个值，同层的满子树全部相同
+    BenchDag(T, cnt, "完全二叉树，按层赋值");
+    free(pool);
+    return 0;
+}
+
+
+//主函数 测试
+int main(int argc, char *argv[]) {
+    INIT_UTF8_CONSOLE();
+    // 命令行模式：
+    //   bench [n] [临时文件] [线程数]   性能测试
+    //   save 文件               从标准输入按先序（-1为空）读树，保存为二进制文件
+    //   load 文件               从二进制文件加载，再执行下面的各项操作
+    //   dag 文件                从二进制文件加载，测试相同子树合并
+    if (argc > 1 && strcmp(argv[1], "bench") == 0) {
+        return RunBenchmark(argc > 2 ? atoi(argv[2]) : 1000000, argc > 3 ? argv[3] : "bitree_bench.btr",
+                            argc > 4 ? atoi(argv[4]) : 4);
+    }
+    if (argc > 2 && strcmp(argv[1], "dag") == 0) {
+        BiTNode *pool;
+        BiTree D;
+        if (!LoadBiTree(argv[2], &D, &pool)) {
+            printf("加载失败：%s\n", argv[2]);
+            return 1;
+        }
+        if (D == NULL) {
+            printf("%s是空树\n", argv[2]);
+            return 0;
+        }
+        BenchDag(D, (int64_t)CountNodes(D), argv[2]);
+        free(pool);
+        return 0;
+    }
+    if (argc > 2 && strcmp(argv[1], "save") == 0) {
+        BiTree S;
+        CreateBiTree(&S);
+        if (!SaveBiTree(S, argv[2])) {
+            printf("保存失败\n");
+            return 1;
+        }
+        printf("已保存%llu个节点到%s\n", (unsigned long long)CountNodes(S), argv[2]);
+        return 0;
+    }
+    BiTree T, find_res;
+    NodeIndex index;
+    int val, height, leaf_cnt;
+
+    // 1. 创建二叉树（同时建立值索引）
+    IndexInit(&index);
+    if (argc > 2 && strcmp(argv[1], "load") == 0) {
+        BiTNode *pool;
+        if (!LoadBiTree(argv[2], &T, &pool)) {
+            printf("加载失败：%s\n", argv[2]);
+            return 1;
+        }
+        IndexBuild(&index, T);
+    } else {
+        printf("输入二叉树节点（-1表示空节点，先序顺序）：\n");
+        UseNodeIndex(&index);
+        CreateBiTree(&T); // 测试用例：1 2 4 -1 -1 5 -1 -1 3 -1 6 -1 -1
+    }
+
+    // 2. 三种递归遍历
+    printf("先序遍历："); PreOrder(T); printf("\n");
+    printf("中序遍历："); InOrder(T); printf("\n");
+    printf("后序遍历："); PostOrder(T); printf("\n");
+
+    // 线索二叉树：不用递归和栈的中序、逆中序遍历
+    ThrNode *thr_pool;
+    ThrTree TT = ToThrTree(T, &thr_pool);
+    printf("线索中序："); ThrInOrder(TT); printf("\n");
+    printf("线索逆中序："); ThrRevInOrder(TT); printf("\n");
+    free(thr_pool);
+
+    // 3. 层序遍历
+    printf("层序遍历："); LevelOrder(T); printf("\n");
+
+    // 4. 求高度
+    height = GetTreeHeight(T);
+    printf("二叉树高度：%d\n", height); // 测试用例输出：3
+
+    // 5. 统计叶子节点
+    leaf_cnt = CountLeaf(T);
+    printf("叶子节点个数：%d\n", leaf_cnt); // 测试用例输出：3（4、5、6）
+
+    // 6. 查找节点
+    printf("输入要查找的节点值：");
+    scanf("%d", &val);
+    find_res = FindNode(T, val);
+    if (find_res) printf("找到节点：%d\n", find_res->data);
+    else printf("未找到该节点\n");
+    printf("哈希索引：值为%d的节点共%lld个\n", val, (long long)IndexFindAll(&index, val, NULL, 0));
+
+    // 7. 判断完全二叉树
+    if (IsCompleteBiTree(T)) printf("是完全二叉树\n");
+    else printf("不是完全二叉树\n"); // 测试用例输出：是
+
+    // 8. 增量维护的聚合信息：插入一个叶子后直接在根上读出结果
+    AugTree A = ToAugTree(T);
+    printf("聚合信息：高度%d，节点%lld，叶子%lld，%s完全二叉树\n", AugHeight(A),
+           (long long)AugSize(A), (long long)AugLeaves(A), AugIsComplete(A) ? "是" : "不是");
+    if (A) {
+        AugTNode *p = A;
+        while (p->lchild) p = p->lchild;
+        AugInsertLeaf(&A, p, 1, val);     // 在最左节点的右空位挂上刚才输入的值
+        printf("插入%d后：高度%d，节点%lld，叶子%lld，%s完全二叉树\n", val, AugHeight(A),
+               (long long)AugSize(A), (long long)AugLeaves(A), AugIsComplete(A) ? "是" : "不是");
+    }
+    DestroyAugTree(A);
 
     return 0;
 }
\ No newline at end of file